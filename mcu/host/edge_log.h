@@ -0,0 +1,34 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 24, 2025
+File function: Binary edge timestamp log shared by the host tools. A log is one EdgeLogHeader followed by
+one EdgeLogRecord per recorded edge, little endian, in the order the edges happened. Times are raw
+COUNT_TIM values, so they wrap every 2^32 ticks exactly as on the part; readers unwrap them.
+*/
+
+#ifndef EDGE_LOG_H
+#define EDGE_LOG_H
+
+#include <stdint.h>
+
+#define EDGE_LOG_MAGIC   0x4C474445u // "EDGL"
+#define EDGE_LOG_VERSION 1
+
+typedef struct {
+    uint32_t magic;      // EDGE_LOG_MAGIC
+    uint16_t version;    // EDGE_LOG_VERSION
+    uint16_t ppr;        // slots per revolution (x4 decoding: 4 * ppr edges)
+    uint32_t tick_hz;    // timestamp clock
+    uint32_t start_time; // when the decoder was seeded
+    uint8_t start_ab;    // AB state it was seeded with
+    uint8_t reserved[3];
+} EdgeLogHeader;
+
+typedef struct {
+    uint32_t time; // COUNT_TIM value at the edge
+    uint8_t ab;    // state after the edge: bit 1 = A, bit 0 = B
+    uint8_t reserved[3];
+} EdgeLogRecord;
+
+#endif // EDGE_LOG_H
@@ -0,0 +1,490 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 23, 2025
+File function: Host simulator and benchmark for the encoder core. The real encoder_axes.c, quad_decoder.c,
+velocity*.c, slot_comp.c, index_pulse.c and zero_speed.c are compiled against mocked registers (mock/stm32l432xx.h) and fed waveforms
+from waveform.c. Virtual time models the part: an edge sets its EXTI pending bit, the handler starts after
+an entry latency once the CPU is free and takes a fixed time to run, and edges that arrive meanwhile pile
+up in PR1 exactly as they would on silicon, so missed edges show up in the firmware's own counters.
+The zero-speed timeout runs as on the part: each edge re-arms the COUNT_TIM channel 3 compare through
+zeroSpeedArm(), and when virtual time reaches CCR3 the compare flag is raised and zeroSpeedService() runs.
+An index pulse is taken every time axis 0 lands on a whole revolution, and drives the index estimator.
+Every SAMPLE_PERIOD_MS the main loop's estimators are evaluated side by side against the true speed.
+
+For each scenario it reports:
+    - error of each estimator against the true speed (mean / rms / max rev/s, mean % above 1 rev/s),
+      after SETTLE_S for the estimators to fill
+    - edge -> decode latency (interrupt entry and queueing) and edge -> main loop output latency
+    - the illegal / lost / re-pended counters from encoder_axes.c
+and once at the end, host wall-clock throughput of the decoder and the full per-edge ISR pipeline.
+
+-w writes the edges of the first scenario run as an edge log (edge_log.h) for replay.c, with timestamps
+taken at the edges themselves as capture mode would record them; -t writes the first scenario's main loop
+samples as the binary telemetry stream (telemetry.h, M/T velocity) for telemetry_csv.c; -d overrides the
+scenario length.
+
+Build and run on the host:
+    make
+    ./encoder_sim [-e entry_ns] [-c handler_ns] [-s scenario] [-d seconds] [-w log.edl] [-t telemetry.bin]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include "main.h"
+#include "encoder_axes.h"
+#include "encoder_snapshot.h"
+#include "quad_decoder.h"
+#include "velocity.h"
+#include "velocity_mt.h"
+#include "velocity_lsq.h"
+#include "slot_comp.h"
+#include "zero_speed.h"
+#include "index_pulse.h"
+#include "telemetry.h"
+#include "waveform.h"
+#include "edge_log.h"
+
+#define SIM_A_PIN     PA6 // same pins as the EXTI build
+#define SIM_B_PIN     PA9
+#define SIM_LINES     0x000003E0 // EXTI9_5 serves both
+#define EDGES_PER_REV (ENCODER_PPR * 4)
+#define REL_MIN_SPEED 1.0 // rev/s: relative error is only averaged above this
+#define SETTLE_S      0.1 // s: estimators fill their windows before errors are counted
+
+// Estimators evaluated side by side (same meaning as VELOCITY_EST_* in main.h)
+enum { EST_PERIOD, EST_MT, EST_LSQ, EST_EDGE, EST_INDEX, EST_COUNT };
+static const char * const EST_NAMES[EST_COUNT] = { "period", "M/T", "LSQ", "edge+slot", "index" };
+
+typedef struct {
+    const char * name;
+    WaveConfig wave;
+} Scenario;
+
+static const Scenario SCENARIOS[] = {
+    // name                   profile        speed end  period dur  jitter slot ppr          seed
+    { "constant 2 rev/s",    { WAVE_CONSTANT, 2,    0,   0,     2.0, 0,     0,   ENCODER_PPR, 1 } },
+    { "constant 20 rev/s",   { WAVE_CONSTANT, 20,   0,   0,     1.0, 0,     0,   ENCODER_PPR, 1 } },
+    { "ramp 0-40 rev/s",     { WAVE_RAMP,     0,    40,  0,     2.0, 0,     0,   ENCODER_PPR, 1 } },
+    { "reversal +-10 rev/s", { WAVE_REVERSAL, 10,   0,   1.0,   2.0, 0,     0,   ENCODER_PPR, 1 } },
+    { "jitter 2 us rms",     { WAVE_CONSTANT, 20,   0,   0,     1.0, 2000,  0,   ENCODER_PPR, 7 } },
+    { "slot error 0.3 edge", { WAVE_CONSTANT, 20,   0,   0,     1.0, 0,     0.3, ENCODER_PPR, 7 } },
+    { "overrun 400 rev/s",   { WAVE_CONSTANT, 400,  0,   0,     0.2, 0,     0,   ENCODER_PPR, 1 } },
+};
+#define SCENARIO_COUNT ((int)(sizeof(SCENARIOS) / sizeof(SCENARIOS[0])))
+
+static const EncoderConfig sim_table[] = {
+    { SIM_A_PIN, SIM_B_PIN, ENCODER_PPR, ENC_RES_X4 },
+};
+
+typedef struct {
+    double sum_abs;
+    double sum_sq;
+    double max_abs;
+    double sum_rel;
+    long rel_samples;
+    long samples;
+} ErrorStats;
+
+typedef struct {
+    double sum;
+    double max;
+    long count;
+} LatencyStats;
+
+// CPU model, set from the command line
+static double entry_s = 150e-9;   // edge -> first handler instruction (12 cycles at 80 MHz, plus sync)
+static double handler_s = 2000e-9; // handler run time
+static double duration_s = 0;     // overrides every scenario's duration if nonzero
+static const char * log_path = NULL;
+static FILE * telemetry_out = NULL;
+
+// Estimator state, as in lab5_main.c
+static uint32_t period_scale, edge_scale;
+static EncoderSnapshot period_snapshot; // cycle period, for EST_PERIOD / EST_MT
+static EncoderSnapshot edge_snapshot;   // slot-compensated single edge period, for EST_EDGE
+static EncoderSnapshot index_snapshot;  // last full revolution, for EST_INDEX
+static IndexTracker index_tracker;
+static MtEstimator mt;
+static LsqWindow lsq;
+static SlotComp slot_comp;
+static uint32_t compare_taken;   // CCR3 value whose match has already been raised
+
+static uint32_t ticks(double t) {
+    return (uint32_t)(int64_t) floor(t * COUNT_TIM_FREQ);
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Drives the A/B pins to ab and latches the EXTI pending bits the change would set
+// Returns: 1 if a pending bit went up
+static int applyPins(uint8_t ab) {
+    uint32_t before = GPIOA->IDR;
+    uint32_t after = before & ~((1u << SIM_A_PIN) | (1u << SIM_B_PIN));
+    after |= ((uint32_t)(ab >> 1) << SIM_A_PIN) | ((uint32_t)(ab & 1) << SIM_B_PIN);
+    GPIOA->IDR = after;
+
+    uint32_t rose = after & ~before;
+    uint32_t fell = before & ~after;
+    uint32_t pend = ((rose & EXTI->RTSR1) | (fell & EXTI->FTSR1)) & EXTI->IMR1;
+    EXTI->PR1 |= pend;
+    return pend != 0;
+}
+
+// Resets the mock part and the estimators, then brings the EXTI front end up as configureInterrupts() does
+static void simInit(const WaveConfig * wave) {
+    mockReset();
+    memset(&encoder_axes, 0, sizeof(encoder_axes));
+    memset(&period_snapshot, 0, sizeof(period_snapshot));
+    memset(&edge_snapshot, 0, sizeof(edge_snapshot));
+    memset(&index_snapshot, 0, sizeof(index_snapshot));
+
+    uint8_t ab = waveStartState(wave);
+    GPIOA->IDR = ((uint32_t)(ab >> 1) << SIM_A_PIN) | ((uint32_t)(ab & 1) << SIM_B_PIN);
+    if (initEncoderAxes(sim_table, 1, 0) != 0) {
+        fprintf(stderr, "sim_table: two axes share an EXTI line\n");
+        exit(1);
+    }
+    EXTI->PR1 = 0; // initEncoderAxes() wrote 1s to clear it; mock PR1 is plain memory
+
+    period_scale = velocityScale(COUNT_TIM_FREQ, ENCODER_PPR);
+    edge_scale = velocityScale(COUNT_TIM_FREQ, EDGES_PER_REV);
+    mtInit(&mt, edge_scale, 0, 0);
+    lsqReset(&lsq);
+    slotCompInit(&slot_comp, 0, 0);
+    indexInit(&index_tracker, EDGES_PER_REV, INDEX_CORRECT);
+    initZeroSpeed(0);
+    compare_taken = COUNT_TIM->CCR3 - 1;
+}
+
+// The body of serviceEncoderLines() for axis 0, run at virtual time t
+// Returns: bitmask of axes that stepped
+static uint32_t simHandler(double t) {
+    COUNT_TIM->CNT = ticks(t);
+
+    uint32_t pending = EXTI->PR1 & SIM_LINES;
+    EXTI->PR1 &= ~pending; // rc_w1 on the part
+
+    uint32_t now = COUNT_TIM->CNT;
+    uint32_t stepped = encoderAxesDispatch(pending, now);
+
+    if (stepped & 1) {
+        int step = encoder_axes.direction[0];
+        EncoderSample latest = { now, encoder_axes.cycle_period[0], encoder_axes.position[0], step };
+        snapshotPublish(&period_snapshot, &latest);
+        latest.period = slotCompEdge(&slot_comp, step, now);
+        snapshotPublish(&edge_snapshot, &latest);
+        lsqAddEdge(&lsq, now, step);
+        zeroSpeedArm(now, encoder_axes.edge_period[0]);
+
+        // handleIndex() in lab5_main.c, with the index gated to position 0 of every turn
+        int32_t raw = encoder_axes.position[0];
+        if (raw % EDGES_PER_REV == 0 && indexPulse(&index_tracker, now, raw, step)) {
+            EncoderSample turn = { now, index_tracker.revolution, indexAbsolute(&index_tracker, raw), step };
+            snapshotPublish(&index_snapshot, &turn);
+        }
+    }
+    return stepped;
+}
+
+// Time COUNT_TIM next reaches CCR3, or INFINITY if that match has already been raised
+static double compareAt(void) {
+    if (COUNT_TIM->CCR3 == compare_taken || !(COUNT_TIM->DIER & TIM_DIER_CC3IE))
+        return INFINITY;
+    return (double) COUNT_TIM->CCR3 / COUNT_TIM_FREQ;
+}
+
+// The compare match and TIM2_IRQHandler, run at virtual time t
+static void simCompare(double t) {
+    compare_taken = COUNT_TIM->CCR3;
+    COUNT_TIM->SR |= TIM_SR_CC3IF;
+    COUNT_TIM->CNT = ticks(t);
+    zeroSpeedService();
+}
+
+// One main loop pass: every estimator's signed velocity in rev/s
+static void simSample(double t, double * out) {
+    uint32_t now = ticks(t);
+    EncoderSample sample, edge;
+    snapshotRead(&period_snapshot, &sample);
+    snapshotRead(&edge_snapshot, &edge);
+    int stopped = zeroSpeedStopped();
+    velocity_q_t v[EST_COUNT];
+
+    v[EST_PERIOD] = velocityBound(velocityFromPeriod(period_scale, sample.period), edge_scale, now - sample.timestamp);
+    v[EST_MT] = mtUpdate(&mt, &sample, now);
+    v[EST_EDGE] = velocityBound(velocityFromSpan(edge_scale, 1u << SLOT_PERIOD_Q, edge.period), edge_scale,
+                                now - edge.timestamp);
+    slotCompUpdate(&slot_comp); // serviceSlotComp()
+
+    EncoderSample turn;
+    snapshotRead(&index_snapshot, &turn);
+    v[EST_INDEX] = velocityBoundSpan(velocityFromSpan(edge_scale, EDGES_PER_REV, turn.period), edge_scale,
+                                     EDGES_PER_REV, now - turn.timestamp);
+
+    LsqSums sums;
+    double fit_velocity, fit_acceleration;
+    lsqRead(&lsq, &sums);
+    v[EST_LSQ] = 0;
+    if (lsqFit(&sums, COUNT_TIM_FREQ, EDGES_PER_REV, &fit_velocity, &fit_acceleration))
+        v[EST_LSQ] = (velocity_q_t)(fabs(fit_velocity) * VELOCITY_ONE);
+
+    for (int i = 0; i < EST_COUNT; i++)
+        out[i] = stopped ? 0 : (double) v[i] / VELOCITY_ONE * (sample.direction < 0 ? -1 : 1);
+}
+
+static void addError(ErrorStats * s, double estimate, double truth) {
+    double err = fabs(estimate - truth);
+    s->sum_abs += err;
+    s->sum_sq += err * err;
+    if (err > s->max_abs)
+        s->max_abs = err;
+    if (fabs(truth) >= REL_MIN_SPEED) {
+        s->sum_rel += err / fabs(truth);
+        s->rel_samples++;
+    }
+    s->samples++;
+}
+
+static void addLatency(LatencyStats * s, double latency) {
+    s->sum += latency;
+    if (latency > s->max)
+        s->max = latency;
+    s->count++;
+}
+
+// Writes the edges as an edge log with exact (capture) timestamps
+static void writeLog(const char * path, const WaveConfig * wave, const WaveEdge * edges, long n) {
+    FILE * out = fopen(path, "wb");
+    if (out == NULL) {
+        perror(path);
+        exit(1);
+    }
+    EdgeLogHeader header = { EDGE_LOG_MAGIC, EDGE_LOG_VERSION, (uint16_t) wave->ppr, COUNT_TIM_FREQ, 0,
+                             waveStartState(wave), {0} };
+    fwrite(&header, sizeof(header), 1, out);
+    for (long i = 0; i < n; i++) {
+        EdgeLogRecord record = { ticks(edges[i].time), edges[i].ab, {0} };
+        fwrite(&record, sizeof(record), 1, out);
+    }
+    fclose(out);
+    printf("wrote %ld edges to %s\n", n, path);
+}
+
+// Writes one main loop sample as a telemetry frame, the way sendTelemetry() in lab5_main.c builds it
+static void writeTelemetry(double t, double mt_velocity) {
+    static uint16_t sequence = 0;
+    uint32_t now = ticks(t);
+    EncoderSample sample;
+    TelemetryRecord record = {0};
+    uint8_t frame[TELEMETRY_FRAME_MAX];
+
+    snapshotRead(&period_snapshot, &sample);
+    record.sequence = sequence++;
+    record.flags = (sample.direction == 1) ? TELEMETRY_FLAG_CW : 0;
+    if (zeroSpeedStopped())
+        record.flags |= TELEMETRY_FLAG_STOPPED;
+    record.timestamp = now;
+    record.position = encoder_axes.position[0];
+    record.velocity = (int32_t) lround(fabs(mt_velocity) * VELOCITY_ONE);
+    record.illegal = (uint16_t) encoder_axes.illegal[0];
+    record.lost = (uint16_t) encoder_axes.lost[0];
+    fwrite(frame, 1, telemetryFrame(&record, frame), telemetry_out);
+}
+
+// Runs one scenario in virtual time and prints its report
+static void runScenario(const Scenario * sc) {
+    WaveConfig config = sc->wave;
+    const WaveConfig * wave = &config;
+    if (duration_s > 0)
+        config.duration = duration_s;
+    double top = fmax(fabs(wave->speed), fabs(wave->speed_end));
+    long max_edges = (long)(top * EDGES_PER_REV * wave->duration * 1.1) + 64;
+    WaveEdge * edges = malloc(max_edges * sizeof(WaveEdge));
+    long n = waveGenerate(wave, edges, max_edges);
+    if (log_path != NULL) {
+        writeLog(log_path, wave, edges, n);
+        log_path = NULL;
+    }
+
+    ErrorStats error[EST_COUNT];
+    LatencyStats decode_latency = {0}, output_latency = {0};
+    memset(error, 0, sizeof(error));
+    simInit(wave);
+
+    long applied = 0;          // edges driven onto the pins
+    long decoded = 0;          // edges a handler has run for
+    long awaiting = 0;         // first edge not yet seen by a main loop sample
+    double pending_since = 0;  // first edge that raised a pending bit since the last handler
+    double cpu_free = 0;       // end of the running handler
+    double next_sample = SAMPLE_PERIOD_MS * 1e-3;
+
+    while (next_sample <= wave->duration) {
+        double edge_at = (applied < n) ? edges[applied].time : INFINITY;
+        double handler_at = (EXTI->PR1 & SIM_LINES) ? fmax(pending_since + entry_s, cpu_free) : INFINITY;
+        double compare_at = compareAt();
+
+        if (compare_at < edge_at && compare_at < handler_at && compare_at <= next_sample) {
+            simCompare(fmax(compare_at + entry_s, cpu_free));
+        }
+        else if (edge_at <= handler_at && edge_at <= next_sample) {
+            if (!(EXTI->PR1 & SIM_LINES) && applyPins(edges[applied].ab))
+                pending_since = edge_at;
+            else
+                applyPins(edges[applied].ab);
+            applied++;
+        }
+        else if (handler_at <= next_sample) {
+            simHandler(handler_at);
+            for (; decoded < applied; decoded++)
+                addLatency(&decode_latency, handler_at - edges[decoded].time);
+
+            // Edges during the handler set pending bits it won't see until it runs again
+            double end = handler_at + handler_s;
+            int repend = 0;
+            while (applied < n && edges[applied].time <= end) {
+                if (applyPins(edges[applied].ab) && !repend) {
+                    pending_since = edges[applied].time;
+                    repend = 1;
+                }
+                applied++;
+            }
+            encoderAxesExit(SIM_LINES);
+            cpu_free = end;
+        }
+        else {
+            double estimate[EST_COUNT];
+            double truth = waveSpeed(wave, next_sample);
+            simSample(next_sample, estimate);
+            if (telemetry_out != NULL)
+                writeTelemetry(next_sample, estimate[EST_MT]);
+            if (next_sample >= SETTLE_S)
+                for (int i = 0; i < EST_COUNT; i++)
+                    addError(&error[i], estimate[i], truth);
+            for (; awaiting < decoded; awaiting++)
+                addLatency(&output_latency, next_sample - edges[awaiting].time);
+            next_sample += SAMPLE_PERIOD_MS * 1e-3;
+        }
+    }
+
+    printf("%s: %ld edges, %.0f edges/s peak\n", sc->name, n, top * EDGES_PER_REV);
+    printf("  %-10s %12s %12s %12s %10s\n", "estimator", "mean rev/s", "rms rev/s", "max rev/s", "mean %");
+    for (int i = 0; i < EST_COUNT; i++) {
+        ErrorStats * s = &error[i];
+        printf("  %-10s %12.4f %12.4f %12.4f %10.3f\n", EST_NAMES[i], s->sum_abs / s->samples,
+               sqrt(s->sum_sq / s->samples), s->max_abs, s->rel_samples ? 100 * s->sum_rel / s->rel_samples : 0.0);
+    }
+    if (decode_latency.count > 0)
+        printf("  edge -> decode %.2f us mean, %.2f us max; edge -> output %.0f us mean, %.0f us max\n",
+               decode_latency.sum / decode_latency.count * 1e6, decode_latency.max * 1e6,
+               output_latency.sum / output_latency.count * 1e6, output_latency.max * 1e6);
+    long position = 0;
+    for (long i = 0; i < decoded; i++)
+        position += edges[i].step;
+    printf("  position %ld of %ld, %lu illegal, %lu lost, %lu re-pended\n\n",
+           (long) encoder_axes.position[0], position, (unsigned long) encoder_axes.illegal[0],
+           (unsigned long) encoder_axes.lost[0], (unsigned long) encoder_axes.repended[0]);
+    if (telemetry_out != NULL) {
+        fclose(telemetry_out);
+        telemetry_out = NULL;
+    }
+    free(edges);
+}
+
+// Times fn over the edge list, repeating until at least 0.2 s of wall clock has passed
+// Returns: edges per second
+static double benchmark(void (*fn)(const WaveEdge *, long), const WaveEdge * edges, long n) {
+    long total = 0;
+    double start = now_seconds(), elapsed;
+    do {
+        fn(edges, n);
+        total += n;
+        elapsed = now_seconds() - start;
+    } while (elapsed < 0.2);
+    return total / elapsed;
+}
+
+// quadDecoderUpdate() alone, as the capture and polling paths use it
+static void benchDecoder(const WaveEdge * edges, long n) {
+    QuadDecoder decoder;
+    quadDecoderInit(&decoder, edges[0].ab, 0);
+    for (long i = 0; i < n; i++)
+        quadDecoderUpdate(&decoder, edges[i].ab, ticks(edges[i].time));
+    if (decoder.illegal)
+        printf("decoder benchmark: unexpected illegal transition\n");
+}
+
+// The EXTI path: pins change, the pending line is dispatched
+static void benchDispatch(const WaveEdge * edges, long n) {
+    for (long i = 0; i < n; i++) {
+        applyPins(edges[i].ab);
+        uint32_t pending = EXTI->PR1;
+        EXTI->PR1 = 0;
+        encoderAxesDispatch(pending, ticks(edges[i].time));
+    }
+}
+
+// The whole per-edge handler body: dispatch, snapshots, slot compensation and the LSQ window
+static void benchHandler(const WaveEdge * edges, long n) {
+    for (long i = 0; i < n; i++) {
+        applyPins(edges[i].ab);
+        simHandler(edges[i].time);
+    }
+}
+
+// Host wall-clock throughput of the per-edge work on a long constant-speed run
+static void runBenchmark(void) {
+    WaveConfig wave = { WAVE_CONSTANT, 50, 0, 0, 1.0, 0, 0, ENCODER_PPR, 1 };
+    long max_edges = (long)(wave.speed * EDGES_PER_REV * wave.duration * 1.1) + 64;
+    WaveEdge * edges = malloc(max_edges * sizeof(WaveEdge));
+    long n = waveGenerate(&wave, edges, max_edges);
+
+    printf("host throughput over %ld edges:\n", n);
+    printf("  quadDecoderUpdate     %8.1f M edges/s\n", benchmark(benchDecoder, edges, n) / 1e6);
+    simInit(&wave);
+    printf("  encoderAxesDispatch   %8.1f M edges/s\n", benchmark(benchDispatch, edges, n) / 1e6);
+    simInit(&wave);
+    printf("  full handler body     %8.1f M edges/s\n", benchmark(benchHandler, edges, n) / 1e6);
+    free(edges);
+}
+
+int main(int argc, char ** argv) {
+    const char * only = NULL;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "e:c:s:d:w:t:")) != -1) {
+        switch (opt) {
+            case 'e': entry_s = atof(optarg) * 1e-9; break;
+            case 'c': handler_s = atof(optarg) * 1e-9; break;
+            case 's': only = optarg; break;
+            case 'd': duration_s = atof(optarg); break;
+            case 'w': log_path = optarg; break;
+            case 't':
+                if ((telemetry_out = fopen(optarg, "wb")) == NULL) {
+                    perror(optarg);
+                    return 1;
+                }
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-e entry_ns] [-c handler_ns] [-s scenario] [-d seconds] [-w log.edl] [-t telemetry.bin]\n",
+                        argv[0]);
+                return 1;
+        }
+    }
+
+    printf("%d PPR x4, handler entry %.0f ns, run %.0f ns, main loop every %d ms\n\n",
+           ENCODER_PPR, entry_s * 1e9, handler_s * 1e9, SAMPLE_PERIOD_MS);
+    for (int i = 0; i < SCENARIO_COUNT; i++)
+        if (only == NULL || strstr(SCENARIOS[i].name, only) != NULL)
+            runScenario(&SCENARIOS[i]);
+    runBenchmark();
+    return 0;
+}
@@ -0,0 +1,35 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 23, 2025
+File function: Backing storage for the mocked peripheral registers declared in mock/stm32l432xx.h.
+*/
+
+#include <string.h>
+#include "stm32l432xx.h"
+
+GPIO_TypeDef mock_gpioa, mock_gpiob, mock_gpioc;
+TIM_TypeDef mock_tim1, mock_tim2, mock_tim15;
+EXTI_TypeDef mock_exti;
+SYSCFG_TypeDef mock_syscfg;
+RCC_TypeDef mock_rcc;
+NVIC_Type mock_nvic;
+
+// Function mockReset:
+// Zeroes every mock register. GPIO MODER comes out of reset as analog (all ones) like the part,
+// which is what initEncoderAxes() checks before turning a pin into an input.
+void mockReset(void) {
+    memset((void *) &mock_gpioa, 0, sizeof(mock_gpioa));
+    memset((void *) &mock_gpiob, 0, sizeof(mock_gpiob));
+    memset((void *) &mock_gpioc, 0, sizeof(mock_gpioc));
+    memset((void *) &mock_tim1, 0, sizeof(mock_tim1));
+    memset((void *) &mock_tim2, 0, sizeof(mock_tim2));
+    memset((void *) &mock_tim15, 0, sizeof(mock_tim15));
+    memset((void *) &mock_exti, 0, sizeof(mock_exti));
+    memset((void *) &mock_syscfg, 0, sizeof(mock_syscfg));
+    memset((void *) &mock_rcc, 0, sizeof(mock_rcc));
+    memset((void *) &mock_nvic, 0, sizeof(mock_nvic));
+    mock_gpioa.MODER = 0xFFFFFFFF;
+    mock_gpiob.MODER = 0xFFFFFFFF;
+    mock_gpioc.MODER = 0xFFFFFFFF;
+}
@@ -0,0 +1,150 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 23, 2025
+File function: Host stand-in for the CMSIS device header. Declares just the peripherals the encoder core
+touches (GPIO, TIM, EXTI, SYSCFG, RCC, NVIC) with the same type and register names, backed by plain
+structs in mock_regs.c instead of memory-mapped hardware. Nothing here behaves like the silicon on its own:
+the simulator drives IDR, CNT, PR1 and the COUNT_TIM compare flag itself (PR1 in particular is rc_w1 on the
+part and plain memory here, as is TIM SR, which is rc_w0).
+*/
+
+#ifndef MOCK_STM32L432XX_H
+#define MOCK_STM32L432XX_H
+
+#include <stdint.h>
+
+#define __IO volatile
+#define __I  volatile const
+
+typedef enum {
+    EXTI0_IRQn     = 6,
+    EXTI1_IRQn     = 7,
+    EXTI2_IRQn     = 8,
+    EXTI3_IRQn     = 9,
+    EXTI4_IRQn     = 10,
+    EXTI9_5_IRQn   = 23,
+    TIM2_IRQn      = 28,
+    EXTI15_10_IRQn = 40,
+} IRQn_Type;
+
+typedef struct {
+    __IO uint32_t MODER;
+    __IO uint32_t OTYPER;
+    __IO uint32_t OSPEEDR;
+    __IO uint32_t PUPDR;
+    __IO uint32_t IDR;
+    __IO uint32_t ODR;
+    __IO uint32_t BSRR;
+    __IO uint32_t LCKR;
+    __IO uint32_t AFR[2];
+    __IO uint32_t BRR;
+} GPIO_TypeDef;
+
+typedef struct {
+    __IO uint32_t CR1;
+    __IO uint32_t CR2;
+    __IO uint32_t SMCR;
+    __IO uint32_t DIER;
+    __IO uint32_t SR;
+    __IO uint32_t EGR;
+    __IO uint32_t CCMR1;
+    __IO uint32_t CCMR2;
+    __IO uint32_t CCER;
+    __IO uint32_t CNT;
+    __IO uint32_t PSC;
+    __IO uint32_t ARR;
+    __IO uint32_t RCR;
+    __IO uint32_t CCR1;
+    __IO uint32_t CCR2;
+    __IO uint32_t CCR3;
+    __IO uint32_t CCR4;
+} TIM_TypeDef;
+
+typedef struct {
+    __IO uint32_t IMR1;
+    __IO uint32_t EMR1;
+    __IO uint32_t RTSR1;
+    __IO uint32_t FTSR1;
+    __IO uint32_t SWIER1;
+    __IO uint32_t PR1;
+    uint32_t RESERVED1[2];
+    __IO uint32_t IMR2;
+    __IO uint32_t EMR2;
+    __IO uint32_t RTSR2;
+    __IO uint32_t FTSR2;
+    __IO uint32_t SWIER2;
+    __IO uint32_t PR2;
+} EXTI_TypeDef;
+
+typedef struct {
+    __IO uint32_t MEMRMP;
+    __IO uint32_t CFGR1;
+    __IO uint32_t EXTICR[4];
+} SYSCFG_TypeDef;
+
+typedef struct {
+    __IO uint32_t CR;
+    __IO uint32_t CFGR;
+    __IO uint32_t AHB1ENR;
+    __IO uint32_t AHB2ENR;
+    __IO uint32_t APB1ENR1;
+    __IO uint32_t APB2ENR;
+    __IO uint32_t CSR;
+} RCC_TypeDef;
+
+typedef struct {
+    __IO uint32_t ISER[8];
+    __IO uint32_t ICER[8];
+    __IO uint32_t ISPR[8];
+    __IO uint32_t ICPR[8];
+    __IO uint8_t  IP[240];
+} NVIC_Type;
+
+extern GPIO_TypeDef mock_gpioa, mock_gpiob, mock_gpioc;
+extern TIM_TypeDef mock_tim1, mock_tim2, mock_tim15;
+extern EXTI_TypeDef mock_exti;
+extern SYSCFG_TypeDef mock_syscfg;
+extern RCC_TypeDef mock_rcc;
+extern NVIC_Type mock_nvic;
+
+#define GPIOA_BASE ((uintptr_t) &mock_gpioa)
+#define GPIOB_BASE ((uintptr_t) &mock_gpiob)
+#define GPIOC_BASE ((uintptr_t) &mock_gpioc)
+
+#define GPIOA  ((GPIO_TypeDef *) GPIOA_BASE)
+#define GPIOB  ((GPIO_TypeDef *) GPIOB_BASE)
+#define GPIOC  ((GPIO_TypeDef *) GPIOC_BASE)
+#define TIM1   (&mock_tim1)
+#define TIM2   (&mock_tim2)
+#define TIM15  (&mock_tim15)
+#define EXTI   (&mock_exti)
+#define SYSCFG (&mock_syscfg)
+#define RCC    (&mock_rcc)
+#define NVIC   (&mock_nvic)
+
+#define RCC_AHB2ENR_GPIOAEN  (1u << 0)
+#define RCC_AHB2ENR_GPIOBEN  (1u << 1)
+#define RCC_AHB2ENR_GPIOCEN  (1u << 2)
+#define RCC_APB2ENR_SYSCFGEN (1u << 0)
+
+#define EXTI_PR1_PIF0 (1u << 0)
+#define EXTI_PR1_PIF1 (1u << 1)
+#define EXTI_PR1_PIF2 (1u << 2)
+#define EXTI_PR1_PIF3 (1u << 3)
+#define EXTI_PR1_PIF4 (1u << 4)
+
+#define TIM_CCMR2_CC3S (3u << 0)
+#define TIM_CCMR2_OC3M ((7u << 4) | (1u << 16))
+#define TIM_CCER_CC3E  (1u << 8)
+#define TIM_DIER_CC3IE (1u << 3)
+#define TIM_SR_CC3IF   (1u << 3)
+#define TIM_EGR_CC3G   (1u << 3)
+
+#define __enable_irq()  ((void) 0)
+#define __disable_irq() ((void) 0)
+
+// Clears every mock register (the state the part comes out of reset in, apart from reset values)
+void mockReset(void);
+
+#endif // MOCK_STM32L432XX_H
@@ -0,0 +1,504 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 24, 2025
+File function: Offline replay of a recorded edge timestamp log (edge_log.h) through the firmware's own
+decoder and velocity estimators, producing the velocity trace the main loop would have reported every
+sample period. Built for long field logs, so the per-edge work is split in two:
+
+    1. Each thread decodes its segment of the log 8 records at a time with GCC vector extensions. Steps come
+       from the Gray code difference ((q_cur - q_prev) & 3 is 1 forward, 3 back, 2 illegal), which needs
+       only the previous record's AB and not the decoder's state, so segments are independent. A first pass
+       sums steps and timestamp wraps per segment; a prefix over segments gives each one its starting
+       position and time, and a second pass walks the samples that fall inside it.
+    2. At each sample, the few edges the estimators look at (the last counted edges back to a reversal, at
+       most LSQ_WINDOW) are found by scanning back, and fed through quadStep(), lsqAddEdge()/lsqFit() and
+       velocityFromPeriod()/velocityBound() exactly as the firmware would. M/T carries state from one
+       sample to the next, so it runs over the samples in order at the end (a few per 10 ms of log).
+
+-v also runs the plain sequential path (quadDecoderUpdate() and lsqAddEdge() on every edge, as
+processEdgeEvents() does in capture mode) and checks every sample against the parallel result.
+The slot-compensated estimator learns over the whole history and isn't replayed.
+
+Build and run on the host:
+    make replay
+    ./replay [-j threads] [-p sample_us] [-o trace.csv | -b trace.bin] [-v] log.edl
+
+The CSV trace has one line per sample: time (ticks), position, direction, then period, M/T and LSQ velocity
+in rev/s. The binary trace is ReplayTraceRecord per sample with velocities in Q16.16 rev/s.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "main.h"
+#include "edge_log.h"
+#include "quad_decoder.h"
+#include "encoder_snapshot.h"
+#include "velocity.h"
+#include "velocity_mt.h"
+#include "velocity_lsq.h"
+
+#define MAX_THREADS 64
+
+typedef uint32_t u32x8 __attribute__((vector_size(32)));
+typedef int32_t i32x8 __attribute__((vector_size(32)));
+
+static const u32x8 EVEN_WORDS = { 0, 2, 4, 6, 8, 10, 12, 14 };   // record times from two loads
+static const u32x8 ODD_WORDS = { 1, 3, 5, 7, 9, 11, 13, 15 };    // record AB words
+static const u32x8 SHIFT_IN = { 8, 0, 1, 2, 3, 4, 5, 6 };        // previous record of each lane
+
+// One sample of the binary trace
+typedef struct {
+    uint32_t time;
+    int32_t position;
+    int32_t velocity[3]; // period, M/T, LSQ (Q16.16 rev/s, signed)
+} ReplayTraceRecord;
+
+// What the main loop has to work with at one sample, rebuilt from the log
+typedef struct {
+    EncoderSample sample;  // as snapshotRead() would return it
+    uint32_t edge_period;  // decoder.edge_period, arms the zero-speed timeout
+    velocity_q_t lsq;      // |lsqFit()| velocity
+    uint8_t lsq_valid;     // lsqFit() succeeded
+    uint8_t counted;       // at least one edge has been counted
+} ReplaySample;
+
+typedef struct {
+    long begin, end;     // records [begin, end)
+    uint32_t position;   // decoder position before begin (wraps like quad_position_t)
+    uint32_t hi;         // timestamp wraps before begin
+    uint32_t steps;      // sums over the segment from pass 1
+    uint32_t illegal;
+    uint32_t wraps;
+    long k_begin, k_end; // samples [k_begin, k_end) land in this segment
+} Segment;
+
+typedef struct {
+    const EdgeLogHeader * header;
+    const EdgeLogRecord * records;
+    long count;
+    uint64_t period;     // sample period in ticks
+    ReplaySample * samples;
+    Segment segments[MAX_THREADS];
+    int threads;
+} Replay;
+
+// Decoded view of 8 consecutive records
+typedef struct {
+    i32x8 step;    // +1, -1 or 0
+    i32x8 illegal; // 1 where A and B both changed
+    i32x8 wrapped; // 1 where the timestamp went past 2^32
+    u32x8 time;
+    u32x8 ab;
+} DecodedBlock;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static inline int32_t hsum(i32x8 v) {
+    int32_t sum = 0;
+    for (int i = 0; i < 8; i++)
+        sum += v[i];
+    return sum;
+}
+
+// Gray code AB to its position in the forward sequence 00 -> 10 -> 11 -> 01
+static inline u32x8 grayToCount(u32x8 ab) {
+    u32x8 a = ab >> 1, b = ab & 1;
+    return (a ^ b) | (b << 1);
+}
+
+static inline void decodeBlock(const EdgeLogRecord * r, uint32_t prev_time, uint32_t prev_ab, DecodedBlock * b) {
+    u32x8 lo, hi;
+    memcpy(&lo, r, sizeof(lo));
+    memcpy(&hi, r + 4, sizeof(hi));
+
+    b->time = __builtin_shuffle(lo, hi, EVEN_WORDS);
+    b->ab = __builtin_shuffle(lo, hi, ODD_WORDS) & 3;
+    u32x8 last_time = __builtin_shuffle(b->time, (u32x8){0} + prev_time, SHIFT_IN);
+    u32x8 last_ab = __builtin_shuffle(b->ab, (u32x8){0} + prev_ab, SHIFT_IN);
+
+    u32x8 d = (grayToCount(b->ab) - grayToCount(last_ab)) & 3;
+    b->step = (d == 3) - (d == 1); // comparisons give -1 for true
+    b->illegal = -(d == 2);
+    b->wrapped = -(b->time < last_time);
+}
+
+static inline uint8_t prevAb(const Replay * rp, long i) {
+    return i > 0 ? rp->records[i - 1].ab : rp->header->start_ab;
+}
+
+static inline uint32_t prevTime(const Replay * rp, long i) {
+    return i > 0 ? rp->records[i - 1].time : rp->header->start_time;
+}
+
+// Pass 1: sums of steps, illegal transitions and wraps over a segment
+static void * sumSegment(void * arg) {
+    Replay * rp = ((void **) arg)[0];
+    Segment * s = ((void **) arg)[1];
+    i32x8 steps = {0}, illegal = {0}, wraps = {0};
+    long i = s->begin;
+
+    for (; i + 8 <= s->end; i += 8) {
+        DecodedBlock b;
+        decodeBlock(&rp->records[i], prevTime(rp, i), prevAb(rp, i), &b);
+        steps += b.step;
+        illegal += b.illegal;
+        wraps += b.wrapped;
+    }
+    s->steps = (uint32_t) hsum(steps);
+    s->illegal = (uint32_t) hsum(illegal);
+    s->wraps = (uint32_t) hsum(wraps);
+    for (; i < s->end; i++) {
+        int step = quadStep(prevAb(rp, i), rp->records[i].ab);
+        if (step == QUAD_ILLEGAL)
+            s->illegal++;
+        else
+            s->steps += (uint32_t) step;
+        s->wraps += rp->records[i].time < prevTime(rp, i);
+    }
+    return NULL;
+}
+
+// Rebuilds what the firmware publishes after decoding records [0, j) at sample time: the last counted
+// edge, the one before it (edge period), the one four before it (cycle period) and the LSQ window
+static void snapshotAt(const Replay * rp, long j, uint32_t position, ReplaySample * out) {
+    uint32_t start = rp->header->start_time;
+    uint32_t window[LSQ_WINDOW];
+    int found = 0, in_window = 0, collecting = 1;
+    uint32_t last_time = 0, prev_time = start, cycle_start = start;
+    int direction = 0;
+
+    for (long i = j - 1; i >= 0 && (found < 5 || collecting); i--) {
+        int step = quadStep(prevAb(rp, i), rp->records[i].ab);
+        if (step == 0 || step == QUAD_ILLEGAL)
+            continue;
+        uint32_t t = rp->records[i].time;
+
+        if (found == 0) {
+            last_time = t;
+            direction = step;
+        }
+        else if (found == 1) {
+            prev_time = t;
+        }
+        if (found == 4)
+            cycle_start = t;
+        found++;
+
+        if (collecting && step == direction && in_window < LSQ_WINDOW)
+            window[in_window++] = t;
+        else
+            collecting = 0;
+    }
+
+    memset(out, 0, sizeof(*out));
+    if (found == 0)
+        return; // nothing published yet: the firmware's snapshot is still all zeros
+
+    out->counted = 1;
+    out->sample.timestamp = last_time;
+    out->sample.period = last_time - cycle_start;
+    out->sample.position = (quad_position_t) position;
+    out->sample.direction = (int8_t) direction;
+    out->edge_period = last_time - prev_time;
+
+    LsqWindow lsq;
+    LsqSums sums;
+    double velocity, acceleration;
+    lsqReset(&lsq);
+    for (int m = in_window - 1; m >= 0; m--)
+        lsqAddEdge(&lsq, window[m], direction);
+    lsqRead(&lsq, &sums);
+    if (lsqFit(&sums, rp->header->tick_hz, rp->header->ppr * 4, &velocity, &acceleration)) {
+        out->lsq = (velocity_q_t)(fabs(velocity) * VELOCITY_ONE);
+        out->lsq_valid = 1;
+    }
+}
+
+// Pass 2: walks the segment's records up to each of its sample times and rebuilds the snapshot there
+static void * sampleSegment(void * arg) {
+    Replay * rp = ((void **) arg)[0];
+    Segment * s = ((void **) arg)[1];
+    uint64_t hi = s->hi;
+    uint32_t position = s->position;
+    long j = s->begin;
+
+    for (long k = s->k_begin; k < s->k_end; k++) {
+        uint64_t t = rp->header->start_time + (uint64_t) k * rp->period;
+
+        while (j < s->end) {
+            if (j + 8 <= s->end) {
+                DecodedBlock b;
+                decodeBlock(&rp->records[j], prevTime(rp, j), prevAb(rp, j), &b);
+                uint64_t block_hi = hi + (uint32_t) hsum(b.wrapped);
+                if (((block_hi << 32) | b.time[7]) <= t) { // whole block before the sample
+                    position += (uint32_t) hsum(b.step);
+                    hi = block_hi;
+                    j += 8;
+                    continue;
+                }
+            }
+            uint64_t record_hi = hi + (rp->records[j].time < prevTime(rp, j));
+            if (((record_hi << 32) | rp->records[j].time) > t)
+                break;
+            int step = quadStep(prevAb(rp, j), rp->records[j].ab);
+            if (step != QUAD_ILLEGAL)
+                position += (uint32_t) step;
+            hi = record_hi;
+            j++;
+        }
+        snapshotAt(rp, j, position, &rp->samples[k - 1]);
+    }
+    return NULL;
+}
+
+static void runThreads(Replay * rp, void * (*fn)(void *)) {
+    pthread_t thread[MAX_THREADS];
+    void * args[MAX_THREADS][2];
+    for (int i = 0; i < rp->threads; i++) {
+        args[i][0] = rp;
+        args[i][1] = &rp->segments[i];
+        pthread_create(&thread[i], NULL, fn, args[i]);
+    }
+    for (int i = 0; i < rp->threads; i++)
+        pthread_join(thread[i], NULL);
+}
+
+// Unwrapped time of record i given the wraps counted before it
+static uint64_t unwrapped(const Replay * rp, long i, uint64_t hi) {
+    hi += rp->records[i].time < prevTime(rp, i);
+    return (hi << 32) | rp->records[i].time;
+}
+
+// Splits the log, runs both passes and returns the number of samples
+static long replaySamples(Replay * rp) {
+    long per = (rp->count / rp->threads + 7) & ~7L;
+    for (int i = 0; i < rp->threads; i++) {
+        Segment * s = &rp->segments[i];
+        s->begin = (i * per < rp->count) ? i * per : rp->count;
+        s->end = ((i + 1) * per < rp->count && i + 1 < rp->threads) ? (i + 1) * per : rp->count;
+    }
+    runThreads(rp, sumSegment);
+
+    // Starting position and wrap count of each segment, then the samples that land in it
+    uint32_t position = 0, hi = 0;
+    for (int i = 0; i < rp->threads; i++) {
+        rp->segments[i].position = position;
+        rp->segments[i].hi = hi;
+        position += rp->segments[i].steps;
+        hi += rp->segments[i].wraps;
+    }
+    uint64_t start = rp->header->start_time;
+    uint64_t last = rp->count ? (((uint64_t) hi << 32) | rp->records[rp->count - 1].time) : start;
+    long samples = (long)((last - start) / rp->period);
+    for (int i = 0; i < rp->threads; i++) {
+        Segment * s = &rp->segments[i];
+        if (i == 0) {
+            s->k_begin = 1;
+        }
+        else if (s->begin < rp->count) {
+            uint64_t first = unwrapped(rp, s->begin, s->hi);
+            s->k_begin = (long)((first - start + rp->period - 1) / rp->period);
+        }
+        else {
+            s->k_begin = samples + 1;
+        }
+        if (s->k_begin > samples + 1)
+            s->k_begin = samples + 1;
+        if (i > 0)
+            rp->segments[i - 1].k_end = s->k_begin;
+    }
+    rp->segments[rp->threads - 1].k_end = samples + 1;
+
+    rp->samples = malloc((samples + 1) * sizeof(ReplaySample));
+    runThreads(rp, sampleSegment);
+    return samples;
+}
+
+// Sequential reference: every edge through quadDecoderUpdate() and lsqAddEdge(), as processEdgeEvents() does
+// Returns: number of samples that differ from the parallel replay
+static long verifySamples(const Replay * rp, long samples) {
+    QuadDecoder decoder;
+    LsqWindow lsq;
+    EncoderSample published = {0};
+    int counted = 0;
+    long mismatches = 0, i = 0;
+    uint64_t hi = 0;
+
+    quadDecoderInit(&decoder, rp->header->start_ab, rp->header->start_time);
+    lsqReset(&lsq);
+    for (long k = 1; k <= samples; k++) {
+        uint64_t t = rp->header->start_time + (uint64_t) k * rp->period;
+        for (; i < rp->count && unwrapped(rp, i, hi) <= t; i++) {
+            hi += rp->records[i].time < prevTime(rp, i);
+            int step = quadDecoderUpdate(&decoder, rp->records[i].ab, rp->records[i].time);
+            if (step != 0) {
+                lsqAddEdge(&lsq, rp->records[i].time, decoder.direction);
+                EncoderSample latest = { decoder.last_time, decoder.cycle_period, decoder.position, decoder.direction };
+                published = latest;
+                counted = 1;
+            }
+        }
+
+        LsqSums sums;
+        double velocity, acceleration;
+        velocity_q_t fit = 0;
+        lsqRead(&lsq, &sums);
+        int valid = lsqFit(&sums, rp->header->tick_hz, rp->header->ppr * 4, &velocity, &acceleration);
+        if (valid)
+            fit = (velocity_q_t)(fabs(velocity) * VELOCITY_ONE);
+
+        const ReplaySample * r = &rp->samples[k - 1];
+        if (memcmp(&r->sample, &published, sizeof(published)) != 0 || r->lsq_valid != valid || r->lsq != fit ||
+            r->counted != counted || (counted && r->edge_period != decoder.edge_period)) {
+            if (mismatches++ < 5)
+                fprintf(stderr, "sample %ld: replay %lu/%lu/%ld/%d lsq %ld, sequential %lu/%lu/%ld/%d lsq %ld\n", k,
+                        (unsigned long) r->sample.timestamp, (unsigned long) r->sample.period, (long) r->sample.position,
+                        r->sample.direction, (long) r->lsq, (unsigned long) published.timestamp,
+                        (unsigned long) published.period, (long) published.position, published.direction, (long) fit);
+        }
+    }
+    return mismatches;
+}
+
+// Pass 3: the main loop's estimators over the samples in order, written out as the trace
+static void writeTrace(const Replay * rp, long samples, FILE * out, int binary) {
+    uint32_t period_scale = velocityScale(rp->header->tick_hz, rp->header->ppr);
+    uint32_t edge_scale = velocityScale(rp->header->tick_hz, rp->header->ppr * 4);
+    MtEstimator mt;
+    velocity_q_t lsq = 0;
+
+    mtInit(&mt, edge_scale, 0, rp->header->start_time);
+    if (!binary)
+        fprintf(out, "time,position,direction,period,mt,lsq\n");
+
+    for (long k = 1; k <= samples; k++) {
+        const ReplaySample * r = &rp->samples[k - 1];
+        const EncoderSample * s = &r->sample;
+        uint32_t now = rp->header->start_time + (uint32_t)((uint64_t) k * rp->period);
+
+        // zeroSpeedArm() timeout from the last edge's period, stopped until the first edge
+        uint32_t w = r->edge_period * ZERO_SPEED_FACTOR;
+        if (r->edge_period > ZERO_SPEED_MAX_US / ZERO_SPEED_FACTOR || w > ZERO_SPEED_MAX_US)
+            w = ZERO_SPEED_MAX_US;
+        if (w < ZERO_SPEED_MIN_US)
+            w = ZERO_SPEED_MIN_US;
+        int stopped = !r->counted || (now - s->timestamp) >= w;
+
+        velocity_q_t v[3];
+        v[0] = velocityBound(velocityFromPeriod(period_scale, s->period), edge_scale, now - s->timestamp);
+        v[1] = mtUpdate(&mt, s, now);
+        if (r->lsq_valid)
+            lsq = r->lsq; // the firmware keeps its last fit until the window refills
+        v[2] = lsq;
+
+        int sign = s->direction < 0 ? -1 : 1;
+        for (int i = 0; i < 3; i++)
+            v[i] = stopped ? 0 : sign * v[i];
+
+        if (binary) {
+            ReplayTraceRecord rec = { now, (int32_t) s->position, { v[0], v[1], v[2] } };
+            fwrite(&rec, sizeof(rec), 1, out);
+        }
+        else {
+            fprintf(out, "%lu,%ld,%d,%.4f,%.4f,%.4f\n", (unsigned long) now, (long) s->position, s->direction,
+                    (double) v[0] / VELOCITY_ONE, (double) v[1] / VELOCITY_ONE, (double) v[2] / VELOCITY_ONE);
+        }
+    }
+}
+
+int main(int argc, char ** argv) {
+    Replay rp = {0};
+    const char * trace = NULL;
+    int binary = 0, verify = 0, opt;
+    long sample_us = SAMPLE_PERIOD_MS * 1000;
+
+    rp.threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    while ((opt = getopt(argc, argv, "j:p:o:b:v")) != -1) {
+        switch (opt) {
+            case 'j': rp.threads = atoi(optarg); break;
+            case 'p': sample_us = atol(optarg); break;
+            case 'o': trace = optarg; binary = 0; break;
+            case 'b': trace = optarg; binary = 1; break;
+            case 'v': verify = 1; break;
+            default:
+                fprintf(stderr, "usage: %s [-j threads] [-p sample_us] [-o trace.csv | -b trace.bin] [-v] log.edl\n",
+                        argv[0]);
+                return 1;
+        }
+    }
+    if (optind != argc - 1 || sample_us <= 0) {
+        fprintf(stderr, "usage: %s [-j threads] [-p sample_us] [-o trace.csv | -b trace.bin] [-v] log.edl\n", argv[0]);
+        return 1;
+    }
+    if (rp.threads < 1)
+        rp.threads = 1;
+    if (rp.threads > MAX_THREADS)
+        rp.threads = MAX_THREADS;
+
+    int fd = open(argv[optind], O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0 || st.st_size < (off_t) sizeof(EdgeLogHeader)) {
+        perror(argv[optind]);
+        return 1;
+    }
+    const uint8_t * map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    rp.header = (const EdgeLogHeader *) map;
+    if (rp.header->magic != EDGE_LOG_MAGIC || rp.header->version != EDGE_LOG_VERSION || rp.header->ppr == 0) {
+        fprintf(stderr, "%s: not an edge log\n", argv[optind]);
+        return 1;
+    }
+    rp.records = (const EdgeLogRecord *)(map + sizeof(EdgeLogHeader));
+    rp.count = (long)((st.st_size - sizeof(EdgeLogHeader)) / sizeof(EdgeLogRecord));
+    rp.period = (uint64_t) sample_us * rp.header->tick_hz / 1000000;
+    if (rp.period == 0)
+        rp.period = 1;
+
+    double start = now_seconds();
+    long samples = replaySamples(&rp);
+    double elapsed = now_seconds() - start;
+
+    uint32_t illegal = 0;
+    for (int i = 0; i < rp.threads; i++)
+        illegal += rp.segments[i].illegal;
+    fprintf(stderr, "%ld edges, %ld samples, %lu illegal, %d threads: %.3f s, %.1f M edges/s\n", rp.count, samples,
+            (unsigned long) illegal, rp.threads, elapsed, rp.count / elapsed / 1e6);
+
+    if (verify) {
+        start = now_seconds();
+        long mismatches = verifySamples(&rp, samples);
+        elapsed = now_seconds() - start;
+        fprintf(stderr, "sequential check: %ld mismatches, %.3f s, %.1f M edges/s\n", mismatches, elapsed,
+                rp.count / elapsed / 1e6);
+        if (mismatches)
+            return 2;
+    }
+
+    if (trace != NULL) {
+        FILE * out = fopen(trace, binary ? "wb" : "w");
+        if (out == NULL) {
+            perror(trace);
+            return 1;
+        }
+        writeTrace(&rp, samples, out, binary);
+        fclose(out);
+    }
+    return 0;
+}
@@ -0,0 +1,112 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 26, 2025
+File function: Host decoder for the binary telemetry stream (../src/telemetry.h). Splits the byte stream at
+the zero delimiters, checks each frame's COBS and CRC with the firmware's own telemetry.c, and writes one
+CSV row per good record. Timestamps are unwrapped into seconds since the first record. Bad frames, records
+missing from the sequence and records the part itself had to drop are counted on stderr.
+
+The input is the raw payload of ITM stimulus port 1 (LOG_FRAME_PORT), e.g. saved from the debugger's SWO
+viewer for that port, or a capture of whatever link carries the frames. A stream joined mid-frame just
+costs the first frame. When text shares the serial link (LOG_OUTPUT_USART), the part ends every chunk of
+it with a zero too; segments that are all printable text and not a valid frame are copied to stderr.
+
+Build and run on the host:
+    make
+    ./telemetry_csv [-f tick_hz] [capture.bin] > samples.csv
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <unistd.h>
+#include "telemetry.h"
+
+#define SEGMENT_MAX 256 // longest segment kept: a frame, or a text chunk (LOG_USART_CHUNK on the part)
+
+// Text chunks from the part are printable ASCII, tabs and line ends
+static int isText(const uint8_t * data, uint32_t len) {
+    for (uint32_t i = 0; i < len; i++) {
+        if (!isprint(data[i]) && data[i] != '\n' && data[i] != '\r' && data[i] != '\t')
+            return 0;
+    }
+    return 1;
+}
+
+int main(int argc, char ** argv) {
+    double tick_hz = 1000000; // COUNT_TIM_FREQ
+    int opt;
+
+    while ((opt = getopt(argc, argv, "f:")) != -1) {
+        switch (opt) {
+            case 'f': tick_hz = atof(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-f tick_hz] [capture.bin]\n", argv[0]);
+                return 1;
+        }
+    }
+    FILE * in = stdin;
+    if (optind < argc && (in = fopen(argv[optind], "rb")) == NULL) {
+        perror(argv[optind]);
+        return 1;
+    }
+
+    uint8_t frame[SEGMENT_MAX];
+    uint32_t len = 0;
+    int overlong = 0;               // current segment ran past SEGMENT_MAX
+    long good = 0, bad = 0, missing = 0;
+    long part_dropped = 0;          // last dropped count the part reported
+    long part_decimated = 0;        // last decimated count the part reported
+    uint16_t next_sequence = 0;
+    uint32_t last_timestamp = 0;
+    uint64_t time = 0;              // unwrapped ticks since the first record
+    int c;
+
+    printf("sequence,time_s,position,velocity_hz,stopped,counter,homed,illegal,lost,cpu_pct,dropped,decimated\n");
+    while ((c = getc(in)) != EOF) {
+        if (c != 0) {
+            if (len < sizeof(frame))
+                frame[len++] = (uint8_t) c;
+            else
+                overlong = 1;
+            continue;
+        }
+
+        TelemetryRecord r;
+        if (len == 0) {
+            // back to back delimiters: nothing lost
+        }
+        else if (overlong || !telemetryParse(frame, len, &r)) {
+            if (isText(frame, len))
+                fwrite(frame, 1, len, stderr);
+            else
+                bad++;
+        }
+        else {
+            if (good > 0) {
+                missing += (uint16_t)(r.sequence - next_sequence);
+                time += r.timestamp - last_timestamp;
+            }
+            next_sequence = r.sequence + 1;
+            last_timestamp = r.timestamp;
+            part_dropped = r.dropped;
+            part_decimated = r.decimated;
+            good++;
+
+            double hz = (double) r.velocity / 65536 * ((r.flags & TELEMETRY_FLAG_CW) ? 1 : -1);
+            printf("%u,%.6f,%ld,%.4f,%d,%d,%d,%u,%u,%.1f,%u,%u\n", r.sequence, time / tick_hz, (long) r.position, hz,
+                   !!(r.flags & TELEMETRY_FLAG_STOPPED), !!(r.flags & TELEMETRY_FLAG_COUNTER),
+                   !!(r.flags & TELEMETRY_FLAG_HOMED), r.illegal, r.lost, r.cpu_permille / 10.0, r.dropped,
+                   r.decimated);
+        }
+        len = 0;
+        overlong = 0;
+    }
+
+    fprintf(stderr, "%ld records, %ld bad frames, %ld missing from the sequence, %ld dropped and %ld decimated "
+            "on the part\n", good, bad, missing, part_dropped, part_decimated);
+    if (in != stdin)
+        fclose(in);
+    return 0;
+}
@@ -0,0 +1,85 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 10, 2025
+File function: Host-side accuracy comparison of the fixed-point velocity engine (velocity.c) against the
+float formula the EXTI interrupt handler used, over every edge period from the fastest to the slowest
+speed the firmware reports. Both are measured against a double precision reference.
+
+Build and run on the host:
+    gcc -O2 -Wall -I../src velocity_accuracy.c ../src/velocity.c -lm -o velocity_accuracy
+    ./velocity_accuracy
+*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+#include "velocity.h"
+
+#define TICK_HZ       1000000 // COUNT_TIM rate
+#define PPR           408
+#define EDGES_PER_REV (PPR * 2) // EXTI path counts both edges of A
+#define MAX_PERIOD    100000    // main loop reports zero speed beyond this (100 ms)
+
+typedef struct {
+    double max_abs;     // rev/s
+    double max_rel;     // fraction
+    double sum_rel;
+    uint32_t worst_abs_period;
+    uint32_t worst_rel_period;
+} ErrorStats;
+
+static void accumulate(ErrorStats * stats, uint32_t period, double value, double reference) {
+    double abs_err = fabs(value - reference);
+    double rel_err = abs_err / reference;
+
+    if (abs_err > stats->max_abs) {
+        stats->max_abs = abs_err;
+        stats->worst_abs_period = period;
+    }
+    if (rel_err > stats->max_rel) {
+        stats->max_rel = rel_err;
+        stats->worst_rel_period = period;
+    }
+    stats->sum_rel += rel_err;
+}
+
+static void report(const char * name, const ErrorStats * stats, uint32_t count) {
+    printf("%-12s max abs %.3e rev/s (period %6u)  max rel %.3e (period %6u)  mean rel %.3e\n",
+           name, stats->max_abs, stats->worst_abs_period, stats->max_rel, stats->worst_rel_period,
+           stats->sum_rel / count);
+}
+
+int main(void) {
+    uint32_t scale = velocityScale(TICK_HZ, EDGES_PER_REV);
+    ErrorStats float_stats = {0};
+    ErrorStats fixed_stats = {0};
+    double max_diff = 0;
+    uint32_t worst_diff_period = 0;
+
+    for (uint32_t period = 1; period <= MAX_PERIOD; period++) {
+        double reference = (double) TICK_HZ / (double) period / (double) EDGES_PER_REV;
+
+        // Exactly what updateVelocity() computed before the fixed-point engine
+        float float_value = 1000000.0f / (float)(period) / 408.0f / 2.0f;
+        double fixed_value = (double) velocityFromPeriod(scale, period) / VELOCITY_ONE;
+
+        accumulate(&float_stats, period, float_value, reference);
+        accumulate(&fixed_stats, period, fixed_value, reference);
+
+        double diff = fabs(fixed_value - (double) float_value);
+        if (diff > max_diff) {
+            max_diff = diff;
+            worst_diff_period = period;
+        }
+    }
+
+    printf("Q%d.%d, scale constant %u, periods 1..%u ticks (%.4f .. %.1f rev/s)\n",
+           31 - VELOCITY_Q, VELOCITY_Q, scale, MAX_PERIOD,
+           (double) TICK_HZ / MAX_PERIOD / EDGES_PER_REV, (double) TICK_HZ / EDGES_PER_REV);
+    report("float", &float_stats, MAX_PERIOD);
+    report("fixed", &fixed_stats, MAX_PERIOD);
+    printf("fixed vs float: max difference %.3e rev/s (period %u), 1 LSB = %.3e rev/s\n",
+           max_diff, worst_diff_period, 1.0 / VELOCITY_ONE);
+    return 0;
+}
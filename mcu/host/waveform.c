@@ -0,0 +1,120 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 23, 2025
+File function: Quadrature waveform generator for the host simulator. The profile gives shaft angle in
+closed form; the angle is walked in steps short enough that it never moves more than a quarter edge per
+step, and each boundary crossing is placed by linear interpolation inside its step. Edge k of the disk
+sits at k + offset[k], so slot error repeats every revolution exactly like a real disk's does.
+*/
+
+#include <math.h>
+#include <stdlib.h>
+#include "waveform.h"
+
+// AB state after count n (forward sequence 00 -> 10 -> 11 -> 01, as in quad_decoder.h)
+static const uint8_t GRAY[4] = { 0b00, 0b10, 0b11, 0b01 };
+
+static uint32_t rng_state;
+
+static double uniform(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return (rng_state + 0.5) / 4294967296.0;
+}
+
+static double gaussian(void) {
+    return sqrt(-2 * log(uniform())) * cos(2 * M_PI * uniform());
+}
+
+// Shaft angle in revolutions at time t
+static double wavePosition(const WaveConfig * c, double t) {
+    switch (c->profile) {
+        case WAVE_RAMP:
+            return c->speed * t + (c->speed_end - c->speed) * t * t / (2 * c->duration);
+        case WAVE_REVERSAL:
+            return c->speed * c->period / (2 * M_PI) * sin(2 * M_PI * t / c->period);
+        default:
+            return c->speed * t;
+    }
+}
+
+// Function waveSpeed:
+// Returns: true shaft speed at time t (rev/s, signed)
+double waveSpeed(const WaveConfig * c, double t) {
+    switch (c->profile) {
+        case WAVE_RAMP:
+            return c->speed + (c->speed_end - c->speed) * t / c->duration;
+        case WAVE_REVERSAL:
+            return c->speed * cos(2 * M_PI * t / c->period);
+        default:
+            return c->speed;
+    }
+}
+
+// Function waveStartState:
+// Returns: AB state at t = 0 (before the first edge)
+uint8_t waveStartState(const WaveConfig * c) {
+    return GRAY[0];
+}
+
+// Function waveGenerate:
+// Walks the profile from 0 to duration and records every edge
+// Arguments: config describes the waveform, edges receives up to max edges
+// Returns: number of edges written
+long waveGenerate(const WaveConfig * c, WaveEdge * edges, long max) {
+    long count = 4 * (long) c->ppr;
+    double * offset = malloc(count * sizeof(double));
+    double top = fmax(fabs(c->speed), fabs(c->speed_end)) * count;
+    double dt = (top > 0) ? fmin(1e-6, 0.25 / top) : 1e-6;
+    long n = 0; // edges counted so far (boundary n lies at n + offset[n mod count])
+    long written = 0;
+    double last_time = 0;
+
+    rng_state = c->seed ? c->seed : 1;
+    for (long k = 0; k < count; k++)
+        offset[k] = (uniform() - 0.5) * c->slot_error;
+
+    // Half an edge in, so the start sits between boundaries 0 and 1 whatever their offsets
+    double prev = 0.5;
+    for (double t = dt; t <= c->duration && written < max; t += dt) {
+        double e = wavePosition(c, t) * count + 0.5;
+
+        while (written < max) {
+            long up = n + 1;
+            double up_at = up + offset[((up % count) + count) % count];
+            double down_at = n + offset[((n % count) + count) % count];
+            double at;
+            int8_t step;
+
+            if (e >= up_at) {
+                at = up_at;
+                step = +1;
+            }
+            else if (e < down_at) {
+                at = down_at;
+                step = -1;
+            }
+            else {
+                break;
+            }
+            n += step;
+
+            double time = t - dt + dt * (at - prev) / (e - prev);
+            if (c->jitter_ns > 0)
+                time += gaussian() * c->jitter_ns * 1e-9;
+            if (time <= last_time) // jitter must not reorder edges
+                time = last_time + 1e-9;
+            last_time = time;
+
+            edges[written].time = time;
+            edges[written].ab = GRAY[n & 3];
+            edges[written].step = step;
+            written++;
+        }
+        prev = e;
+    }
+    free(offset);
+    return written;
+}
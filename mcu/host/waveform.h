@@ -0,0 +1,47 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 23, 2025
+File function: Header for the host-side quadrature waveform generator. A speed profile is integrated into
+shaft angle, and an A/B edge is emitted wherever the angle crosses a slot boundary. Boundaries can be
+displaced to model an imperfect disk, and edge times can be jittered to model noisy sensors.
+*/
+
+#ifndef WAVEFORM_H
+#define WAVEFORM_H
+
+#include <stdint.h>
+
+// Values which "profile" can take on
+#define WAVE_CONSTANT 0 // speed the whole time
+#define WAVE_RAMP     1 // speed to speed_end linearly over duration
+#define WAVE_REVERSAL 2 // speed * cos(2 pi t / period): sweeps back and forth through zero
+
+typedef struct {
+    int profile;
+    double speed;      // rev/s (start speed for a ramp, amplitude for a reversal)
+    double speed_end;  // rev/s at the end of a ramp
+    double period;     // s, one back-and-forth of a reversal
+    double duration;   // s
+    double jitter_ns;  // rms timing noise added to each edge
+    double slot_error; // peak-to-peak displacement of each slot boundary, in edges (0 .. <1)
+    uint32_t ppr;      // slots per revolution (4 * ppr edges)
+    uint32_t seed;
+} WaveConfig;
+
+// One A or B transition
+typedef struct {
+    double time; // s
+    uint8_t ab;  // state after the edge: bit 1 = A, bit 0 = B
+    int8_t step; // +1 forward, -1 backward
+} WaveEdge;
+
+///////////////////////////////////////////////////////////////////////////////
+// Function prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+double waveSpeed(const WaveConfig * config, double t);
+uint8_t waveStartState(const WaveConfig * config);
+long waveGenerate(const WaveConfig * config, WaveEdge * edges, long max);
+
+#endif // WAVEFORM_H
@@ -0,0 +1,71 @@
+// STM32L432KC_DMA.c
+// Source code for DMA functions
+
+#include "STM32L432KC_DMA.h"
+
+/* Returns a pointer to a channel's register block.
+ *    -- DMAx: DMA1 or DMA2
+ *    -- channel: channel number, 1 to 7
+ *    -- return: pointer to the channel's CCR/CNDTR/CPAR/CMAR registers */
+DMA_Channel_TypeDef * dmaChannel(DMA_TypeDef * DMAx, int channel) {
+  // Channel register blocks start at offset 0x08 and are 0x14 bytes apart (RM 11.6)
+  return (DMA_Channel_TypeDef *) ((uintptr_t) DMAx + 0x08 + 0x14 * (channel - 1));
+}
+
+/* Configures a channel without enabling it.
+ *    -- request: CxS request number from the DMA request mapping table (RM 11.3.2)
+ *    -- dir: DMA_PERIPH_TO_MEM or DMA_MEM_TO_PERIPH
+ *    -- size: DMA_SIZE_8, DMA_SIZE_16 or DMA_SIZE_32
+ *    -- mode: DMA_NORMAL or DMA_CIRCULAR */
+void initDMA(DMA_TypeDef * DMAx, int channel, int request, int dir, int size, int mode) {
+  DMA_Channel_TypeDef * DMA_CH = dmaChannel(DMAx, channel);
+  DMA_Request_TypeDef * DMA_SEL = (DMAx == DMA1) ? DMA1_CSELR : DMA2_CSELR;
+
+  // Turn on DMA clock
+  if (DMAx == DMA1)
+    RCC->AHB1ENR |= RCC_AHB1ENR_DMA1EN;
+  else
+    RCC->AHB1ENR |= RCC_AHB1ENR_DMA2EN;
+
+  DMA_CH->CCR &= ~DMA_CCR_EN; // Disable channel while configuring
+
+  // Select request (4 bits per channel)
+  DMA_SEL->CSELR &= ~(0xF << (4 * (channel - 1)));
+  DMA_SEL->CSELR |= ((request & 0xF) << (4 * (channel - 1)));
+
+  DMA_CH->CCR = 0;
+  DMA_CH->CCR |= DMA_CCR_MINC; // Increment memory address, peripheral address fixed
+  DMA_CH->CCR |= _VAL2FLD(DMA_CCR_PSIZE, size) | _VAL2FLD(DMA_CCR_MSIZE, size);
+  DMA_CH->CCR |= _VAL2FLD(DMA_CCR_PL, 0b10); // High priority
+  if (dir == DMA_MEM_TO_PERIPH)
+    DMA_CH->CCR |= DMA_CCR_DIR;
+  if (mode == DMA_CIRCULAR)
+    DMA_CH->CCR |= DMA_CCR_CIRC;
+
+  dmaClearFlags(DMAx, channel);
+}
+
+/* Loads addresses and transfer count and enables the channel. */
+void startDMA(DMA_TypeDef * DMAx, int channel, volatile void * periph, void * mem, uint16_t count) {
+  DMA_Channel_TypeDef * DMA_CH = dmaChannel(DMAx, channel);
+
+  DMA_CH->CCR &= ~DMA_CCR_EN; // Addresses and count can only be written while disabled
+  DMA_CH->CPAR = (uint32_t) (uintptr_t) periph;
+  DMA_CH->CMAR = (uint32_t) (uintptr_t) mem;
+  DMA_CH->CNDTR = count;
+  DMA_CH->CCR |= DMA_CCR_EN;
+}
+
+void stopDMA(DMA_TypeDef * DMAx, int channel) {
+  dmaChannel(DMAx, channel)->CCR &= ~DMA_CCR_EN;
+}
+
+/* Returns the number of transfers left before the channel wraps (circular) or completes. */
+uint16_t dmaRemaining(DMA_TypeDef * DMAx, int channel) {
+  return (uint16_t) dmaChannel(DMAx, channel)->CNDTR;
+}
+
+/* Clears the global, transfer complete, half transfer and error flags of a channel. */
+void dmaClearFlags(DMA_TypeDef * DMAx, int channel) {
+  DMAx->IFCR = (0xF << (4 * (channel - 1))); // Write 1 to clear
+}
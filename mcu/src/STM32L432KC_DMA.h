@@ -0,0 +1,38 @@
+// STM32L432KC_DMA.h
+// Header for DMA functions
+
+#ifndef STM32L4_DMA_H
+#define STM32L4_DMA_H
+
+#include <stdint.h>
+#include <stm32l432xx.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+// Values which "dir" can take on in initDMA()
+#define DMA_PERIPH_TO_MEM 0
+#define DMA_MEM_TO_PERIPH 1
+
+// Values which "size" can take on in initDMA() (peripheral and memory use the same width)
+#define DMA_SIZE_8   0
+#define DMA_SIZE_16  1
+#define DMA_SIZE_32  2
+
+// Values which "mode" can take on in initDMA()
+#define DMA_NORMAL   0
+#define DMA_CIRCULAR 1
+
+///////////////////////////////////////////////////////////////////////////////
+// Function prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+DMA_Channel_TypeDef * dmaChannel(DMA_TypeDef * DMAx, int channel);
+void initDMA(DMA_TypeDef * DMAx, int channel, int request, int dir, int size, int mode);
+void startDMA(DMA_TypeDef * DMAx, int channel, volatile void * periph, void * mem, uint16_t count);
+void stopDMA(DMA_TypeDef * DMAx, int channel);
+uint16_t dmaRemaining(DMA_TypeDef * DMAx, int channel);
+void dmaClearFlags(DMA_TypeDef * DMAx, int channel);
+
+#endif
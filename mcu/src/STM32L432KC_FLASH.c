@@ -3,7 +3,82 @@
 
 #include "STM32L432KC_FLASH.h"
 
+// Error flags that must be clear before starting an operation
+#define FLASH_SR_ERRORS (FLASH_SR_OPERR | FLASH_SR_PROGERR | FLASH_SR_WRPERR | FLASH_SR_PGAERR | \
+                         FLASH_SR_SIZERR | FLASH_SR_PGSERR | FLASH_SR_MISERR | FLASH_SR_FASTERR | \
+                         FLASH_SR_RDERR | FLASH_SR_OPTVERR)
+
 void configureFlash() {
   FLASH->ACR |= FLASH_ACR_LATENCY_4WS;
   FLASH->ACR |= FLASH_ACR_PRFTEN;
-}
\ No newline at end of file
+}
+
+// Unlocks FLASH_CR with the key sequence (RM 3.3.5)
+static void flashUnlock(void) {
+  if (FLASH->CR & FLASH_CR_LOCK) {
+    FLASH->KEYR = 0x45670123;
+    FLASH->KEYR = 0xCDEF89AB;
+  }
+}
+
+static void flashLock(void) {
+  FLASH->CR |= FLASH_CR_LOCK;
+}
+
+// Waits for the current operation and returns 0 on success, -1 on any error flag
+static int flashWait(void) {
+  while (FLASH->SR & FLASH_SR_BSY);
+  if (FLASH->SR & FLASH_SR_ERRORS) {
+    FLASH->SR = FLASH_SR_ERRORS; // Write 1 to clear
+    return -1;
+  }
+  return 0;
+}
+
+/* Erases one 2 KB page.
+ *    -- page: page number, 0 to 127 (0x08000000 + page * 2 KB)
+ *    -- return: 0 on success, -1 on error
+ * The CPU stalls on instruction fetches from flash until the erase finishes (~22 ms). */
+int flashErasePage(int page) {
+  flashUnlock();
+  FLASH->SR = FLASH_SR_ERRORS; // Clear stale errors
+  while (FLASH->SR & FLASH_SR_BSY);
+
+  FLASH->CR &= ~FLASH_CR_PNB;
+  FLASH->CR |= FLASH_CR_PER | _VAL2FLD(FLASH_CR_PNB, page);
+  FLASH->CR |= FLASH_CR_STRT;
+  int result = flashWait();
+  FLASH->CR &= ~FLASH_CR_PER;
+
+  flashLock();
+  return result;
+}
+
+/* Programs erased flash one double word at a time.
+ *    -- address: destination, must be 8 byte aligned
+ *    -- data, len: bytes to write; the last double word is padded with 0xFF
+ *    -- return: 0 on success, -1 on error */
+int flashProgram(uint32_t address, const void * data, uint32_t len) {
+  const uint8_t * bytes = (const uint8_t *) data;
+  int result = 0;
+
+  flashUnlock();
+  FLASH->SR = FLASH_SR_ERRORS;
+  while (FLASH->SR & FLASH_SR_BSY);
+  FLASH->CR |= FLASH_CR_PG;
+
+  for (uint32_t offset = 0; offset < len && result == 0; offset += 8) {
+    uint32_t word[2] = {0xFFFFFFFF, 0xFFFFFFFF};
+    for (uint32_t i = 0; i < 8 && offset + i < len; i++)
+      ((uint8_t *) word)[i] = bytes[offset + i];
+
+    // Both words must be written back to back (RM 3.3.7)
+    *(volatile uint32_t *)(uintptr_t)(address + offset) = word[0];
+    *(volatile uint32_t *)(uintptr_t)(address + offset + 4) = word[1];
+    result = flashWait();
+  }
+
+  FLASH->CR &= ~FLASH_CR_PG;
+  flashLock();
+  return result;
+}
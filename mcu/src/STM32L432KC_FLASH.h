@@ -7,10 +7,22 @@
 #include <stdint.h>
 #include <stm32l432xx.h>
 
+///////////////////////////////////////////////////////////////////////////////
+// Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+#define FLASH_BASE_ADDR  0x08000000UL
+#define FLASH_PAGE_BYTES 2048 // erase granularity (RM 3.3.1)
+
+// Address of the first byte of a page
+#define FLASH_PAGE_ADDR(page) (FLASH_BASE_ADDR + (uint32_t)(page) * FLASH_PAGE_BYTES)
+
 ///////////////////////////////////////////////////////////////////////////////
 // Function prototypes
 ///////////////////////////////////////////////////////////////////////////////
 
 void configureFlash();
+int flashErasePage(int page);
+int flashProgram(uint32_t address, const void * data, uint32_t len);
 
-#endif
\ No newline at end of file
+#endif
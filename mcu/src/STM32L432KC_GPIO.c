@@ -88,6 +88,22 @@ void pinMode(int gpio_pin, int function) {
 	}
 }
 
+void pinResistor(int gpio_pin, int setting) {
+	// Get pointer to base address of the corresponding GPIO pin and pin offset
+	GPIO_TypeDef * GPIO_PORT_PTR = gpioPinToBase(gpio_pin);
+	int pin_offset = gpioPinOffset(gpio_pin);
+
+	GPIO_PORT_PTR->PUPDR &= ~(0b11 << 2*pin_offset);
+	switch(setting) {
+		case GPIO_PULL_UP:
+			GPIO_PORT_PTR->PUPDR |= (0b01 << 2*pin_offset);
+			break;
+		case GPIO_PULL_DOWN:
+			GPIO_PORT_PTR->PUPDR |= (0b10 << 2*pin_offset);
+			break;
+	}
+}
+
 int digitalRead(int gpio_pin) {
 	// Get pointer to base address of the corresponding GPIO pin and pin offset
 	GPIO_TypeDef * GPIO_PORT_PTR = gpioPinToBase(gpio_pin);
@@ -0,0 +1,44 @@
+// STM32L432KC_LPTIM.c
+// LPTIM functions
+
+#include "STM32L432KC_LPTIM.h"
+
+void initEncoderLPTIM(LPTIM_TypeDef * LPTIMx, uint32_t interrupts){
+  // Quadrature encoder: IN1/IN2 clock the counter up or down. The kernel clock (selected in
+  // RCC->CCIPR by the caller) must be internal and at least 4x the input edge rate.
+  LPTIMx->CR &= ~LPTIM_CR_ENABLE; // CFGR and IER can only be written while disabled
+
+  LPTIMx->CFGR &= ~(LPTIM_CFGR_CKSEL | LPTIM_CFGR_CKPOL | LPTIM_CFGR_CKFLT | LPTIM_CFGR_PRESC |
+                    LPTIM_CFGR_COUNTMODE);
+  LPTIMx->CFGR |= _VAL2FLD(LPTIM_CFGR_CKPOL, 0b10); // both edges of both inputs (x4 resolution)
+  LPTIMx->CFGR |= _VAL2FLD(LPTIM_CFGR_CKFLT, 0b01); // input must be stable for 2 kernel clocks
+  LPTIMx->CFGR |= LPTIM_CFGR_ENC;
+
+  LPTIMx->IER = interrupts;
+
+  LPTIMx->CR |= LPTIM_CR_ENABLE;
+  LPTIMx->ARR = 0xFFFF; // free-running over the 16 bit range
+  while (!(LPTIMx->ISR & LPTIM_ISR_ARROK));
+  LPTIMx->ICR = LPTIM_ICR_ARROKCF;
+
+  // Start counting continuously
+  LPTIMx->CR |= LPTIM_CR_CNTSTRT;
+}
+
+uint16_t readLPTIM(LPTIM_TypeDef * LPTIMx){
+  // CNT runs from an asynchronous clock: only trust two identical reads in a row
+  uint16_t count;
+  do {
+    count = (uint16_t) LPTIMx->CNT;
+  } while ((uint16_t) LPTIMx->CNT != count);
+  return count;
+}
+
+void setCompareLPTIM(LPTIM_TypeDef * LPTIMx, uint16_t compare){
+  // CMP must stay below ARR (0xFFFF)
+  if (compare == 0xFFFF)
+    compare = 0xFFFE;
+  LPTIMx->CMP = compare;
+  while (!(LPTIMx->ISR & LPTIM_ISR_CMPOK)); // write lands a few kernel clocks later
+  LPTIMx->ICR = LPTIM_ICR_CMPOKCF;
+}
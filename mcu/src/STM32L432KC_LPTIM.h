@@ -0,0 +1,18 @@
+// STM32L432KC_LPTIM.h
+// Header for LPTIM functions
+
+#ifndef STM32L4_LPTIM_H
+#define STM32L4_LPTIM_H
+
+#include <stdint.h> // Include stdint header
+#include <stm32l432xx.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// Function prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+void initEncoderLPTIM(LPTIM_TypeDef * LPTIMx, uint32_t interrupts);
+uint16_t readLPTIM(LPTIM_TypeDef * LPTIMx);
+void setCompareLPTIM(LPTIM_TypeDef * LPTIMx, uint16_t compare);
+
+#endif
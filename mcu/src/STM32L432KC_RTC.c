@@ -0,0 +1,42 @@
+// STM32L432KC_RTC.c
+// RTC functions
+
+#include "STM32L432KC_RTC.h"
+
+void enableLSI(void){
+  // 32 kHz internal RC, keeps running in Stop 2
+  RCC->CSR |= RCC_CSR_LSION;
+  while (!(RCC->CSR & RCC_CSR_LSIRDY));
+}
+
+void initRTCWakeup(uint32_t ticks){
+  // Periodic wakeup every "ticks" periods of RTC_WAKEUP_HZ. Clocks the RTC from LSI (call enableLSI() first).
+  // The RTC lives in the backup domain: unlock it through PWR first.
+  RCC->APB1ENR1 |= RCC_APB1ENR1_PWREN | RCC_APB1ENR1_RTCAPBEN;
+  PWR->CR1 |= PWR_CR1_DBP;
+
+  if ((RCC->BDCR & RCC_BDCR_RTCSEL) != _VAL2FLD(RCC_BDCR_RTCSEL, 0b10)) {
+    RCC->BDCR |= RCC_BDCR_BDRST; // RTCSEL can only change after a backup domain reset
+    RCC->BDCR &= ~RCC_BDCR_BDRST;
+    RCC->BDCR |= _VAL2FLD(RCC_BDCR_RTCSEL, 0b10); // LSI
+  }
+  RCC->BDCR |= RCC_BDCR_RTCEN;
+
+  // Remove RTC register write protection
+  RTC->WPR = 0xCA;
+  RTC->WPR = 0x53;
+
+  RTC->CR &= ~(RTC_CR_WUTE | RTC_CR_WUTIE);
+  while (!(RTC->ISR & RTC_ISR_WUTWF)); // wait until WUTR may be written
+  RTC->WUTR = ticks - 1;
+  RTC->CR &= ~RTC_CR_WUCKSEL; // RTCCLK / 16
+  RTC->ISR &= ~RTC_ISR_WUTF;
+  RTC->CR |= RTC_CR_WUTIE | RTC_CR_WUTE;
+
+  RTC->WPR = 0xFF; // write protect again
+}
+
+void clearRTCWakeup(void){
+  // WUTF is rc_w0; INIT is the only other writable bit in ISR and is left as it was
+  RTC->ISR &= ~RTC_ISR_WUTF;
+}
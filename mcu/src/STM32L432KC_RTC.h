@@ -0,0 +1,25 @@
+// STM32L432KC_RTC.h
+// Header for RTC functions
+
+#ifndef STM32L4_RTC_H
+#define STM32L4_RTC_H
+
+#include <stdint.h> // Include stdint header
+#include <stm32l432xx.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+#define LSI_FREQ 32000                 // LSI clock is 32 kHz
+#define RTC_WAKEUP_HZ (LSI_FREQ / 16)  // wakeup timer tick with RTCCLK = LSI and WUCKSEL = RTC/16
+
+///////////////////////////////////////////////////////////////////////////////
+// Function prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+void enableLSI(void);
+void initRTCWakeup(uint32_t ticks);
+void clearRTCWakeup(void);
+
+#endif
@@ -30,6 +30,56 @@ void initCounterTIM(TIM_TypeDef * TIMx){
   TIMx->CR1 |= 1; // Set CEN = 1
 }
 
+void initEncoderTIM(TIM_TypeDef * TIMx){
+  // Quadrature encoder interface: CH1/CH2 inputs clock the counter directly
+  TIMx->CR1 &= ~TIM_CR1_CEN; // Disable counter while configuring
+
+  // Map IC1 -> TI1 and IC2 -> TI2, filter N=8 at f_CK_INT to reject glitches
+  TIMx->CCMR1 &= ~(TIM_CCMR1_CC1S | TIM_CCMR1_CC2S | TIM_CCMR1_IC1F | TIM_CCMR1_IC2F);
+  TIMx->CCMR1 |= _VAL2FLD(TIM_CCMR1_CC1S, 0b01) | _VAL2FLD(TIM_CCMR1_CC2S, 0b01);
+  TIMx->CCMR1 |= _VAL2FLD(TIM_CCMR1_IC1F, 0b0011) | _VAL2FLD(TIM_CCMR1_IC2F, 0b0011);
+
+  // Non-inverted inputs
+  TIMx->CCER &= ~(TIM_CCER_CC1P | TIM_CCER_CC1NP | TIM_CCER_CC2P | TIM_CCER_CC2NP);
+
+  // Encoder mode 3: count on both edges of TI1 and TI2 (x4 resolution)
+  TIMx->SMCR &= ~TIM_SMCR_SMS;
+  TIMx->SMCR |= _VAL2FLD(TIM_SMCR_SMS, 0b011);
+
+  TIMx->PSC = 0;
+  TIMx->ARR = 0xFFFF; // free-running over the 16 bit range (TIM2 also fits)
+  TIMx->EGR |= 1;     // Generate an update event to load PSC/ARR
+  TIMx->CNT = 0;
+  // Enable counter
+  TIMx->CR1 |= TIM_CR1_CEN;
+}
+
+void initCaptureTIM(TIM_TypeDef * TIMx, int channel, int edge){
+  // Input capture on channel 1-4: CCRx latches CNT on the selected edge(s) of TIx
+  volatile uint32_t * CCMR = (channel <= 2) ? &TIMx->CCMR1 : &TIMx->CCMR2;
+  int ccmr_shift = ((channel - 1) % 2) * 8;
+  int ccer_shift = (channel - 1) * 4;
+
+  TIMx->CCER &= ~(0b1011 << ccer_shift); // Disable capture while configuring (CCxE, CCxP, CCxNP)
+
+  // CCxS = 01 (ICx mapped on TIx), ICxF = 0011 (filter N=8 at f_CK_INT), no input prescaler
+  *CCMR &= ~(0xFF << ccmr_shift);
+  *CCMR |= (0b01 << ccmr_shift) | (0b0011 << (ccmr_shift + 4));
+
+  switch(edge) {
+    case TIM_CAPTURE_RISING:
+      break;
+    case TIM_CAPTURE_FALLING:
+      TIMx->CCER |= (0b0010 << ccer_shift); // CCxP = 1
+      break;
+    case TIM_CAPTURE_BOTH:
+      TIMx->CCER |= (0b1010 << ccer_shift); // CCxP = CCxNP = 1
+      break;
+  }
+
+  TIMx->CCER |= (0b0001 << ccer_shift); // CCxE = 1
+}
+
 void delay_millis(TIM_TypeDef * TIMx, uint32_t ms){
   TIMx->ARR = ms;// Set timer max count
   TIMx->EGR |= 1;     // Force update
@@ -8,12 +8,23 @@
 #include <stm32l432xx.h>
 #include "STM32L432KC_GPIO.h"
 
+///////////////////////////////////////////////////////////////////////////////
+// Definitions
+///////////////////////////////////////////////////////////////////////////////
+
+// Values which "edge" can take on in initCaptureTIM()
+#define TIM_CAPTURE_RISING  0
+#define TIM_CAPTURE_FALLING 1
+#define TIM_CAPTURE_BOTH    2
+
 ///////////////////////////////////////////////////////////////////////////////
 // Function prototypes
 ///////////////////////////////////////////////////////////////////////////////
 
 void initTIM(TIM_TypeDef * TIMx);
 void initCounterTIM(TIM_TypeDef * TIMx);
+void initEncoderTIM(TIM_TypeDef * TIMx);
+void initCaptureTIM(TIM_TypeDef * TIMx, int channel, int edge);
 void delay_millis(TIM_TypeDef * TIMx, uint32_t ms);
 void delay_micros(TIM_TypeDef * TIMx, uint32_t us);
 
@@ -6,6 +6,8 @@
 #include "STM32L432KC_GPIO.h"
 #include "STM32L432KC_RCC.h"
 
+static uint32_t kernel_hz[3]; // kernel clock each USART was last set up with, indexed by USART_ID
+
 USART_TypeDef * id2Port(int USART_ID) {
     USART_TypeDef * USART;
     switch(USART_ID){
@@ -22,15 +24,43 @@ USART_TypeDef * id2Port(int USART_ID) {
 }
 
 USART_TypeDef * initUSART(int USART_ID, int baud_rate) {
+    return initUSARTClock(USART_ID, baud_rate, USART_CLK_HSI16, USART_FLOW_NONE);
+}
+
+/* Returns the frequency a USART would run from with a given kernel clock.
+ *    -- clock: USART_CLK_PCLK, USART_CLK_SYSCLK or USART_CLK_HSI16 */
+uint32_t usartKernelClock(int USART_ID, int clock) {
+    switch(clock){
+        case USART_CLK_PCLK :
+            // USART1 is on APB2, USART2 on APB1
+            if (USART_ID == USART1_ID)
+                return SystemCoreClock >> APBPrescTable[_FLD2VAL(RCC_CFGR_PPRE2, RCC->CFGR)];
+            return SystemCoreClock >> APBPrescTable[_FLD2VAL(RCC_CFGR_PPRE1, RCC->CFGR)];
+        case USART_CLK_SYSCLK :
+            return SystemCoreClock;
+        default :
+            return HSI_FREQ;
+    }
+}
+
+/* Sets up a USART for 8N1 at the closest baud rate the kernel clock allows, f_CK / n. 16x oversampling
+ * is used down to n = 16; faster rates switch to 8x oversampling (less noise immunity), up to f_CK / 8.
+ *    -- clock: USART_CLK_PCLK, USART_CLK_SYSCLK or USART_CLK_HSI16
+ *    -- flow: USART_FLOW_NONE, or USART_FLOW_RTS_CTS to hold off transmission while the peer deasserts CTS
+ *       and deassert RTS while a received byte has not been read
+ *    -- return: the USART; check the result with usartBaudErrorPpm() */
+USART_TypeDef * initUSARTClock(int USART_ID, int baud_rate, int clock, int flow) {
     gpioEnable(GPIO_PORT_A);  // Enable clock for GPIOA
-    RCC->CR |= RCC_CR_HSION;  // Turn on HSI 16 MHz clock
+    if (clock == USART_CLK_HSI16)
+        RCC->CR |= RCC_CR_HSION;  // Turn on HSI 16 MHz clock
 
     USART_TypeDef * USART = id2Port(USART_ID); // Get pointer to USART
 
     switch(USART_ID){
         case USART1_ID :
             RCC->APB2ENR |= RCC_APB2ENR_USART1EN; // Set USART1EN
-            RCC->CCIPR |= (0b10 << RCC_CCIPR_USART1SEL_Pos); // Set HSI16 (16 MHz) as USART clock source
+            RCC->CCIPR &= ~RCC_CCIPR_USART1SEL;
+            RCC->CCIPR |= _VAL2FLD(RCC_CCIPR_USART1SEL, clock); // Kernel clock
 
             GPIOA->AFR[1] |= (0b111 << GPIO_AFRH_AFSEL9_Pos) | (0b111 << GPIO_AFRH_AFSEL10_Pos);
 
@@ -38,10 +68,16 @@ USART_TypeDef * initUSART(int USART_ID, int baud_rate) {
             pinMode(PA9, GPIO_ALT); // TX
             pinMode(PA10, GPIO_ALT); // RX
 
+            if (flow == USART_FLOW_RTS_CTS) {
+                GPIOA->AFR[1] |= (0b111 << GPIO_AFRH_AFSEL11_Pos) | (0b111 << GPIO_AFRH_AFSEL12_Pos);
+                pinMode(PA11, GPIO_ALT); // CTS
+                pinMode(PA12, GPIO_ALT); // RTS
+            }
             break;
         case USART2_ID :
             RCC->APB1ENR1 |= RCC_APB1ENR1_USART2EN; // Set USART2EN
-            RCC->CCIPR |= (0b10 << RCC_CCIPR_USART2SEL_Pos); // Set HSI16 (16 MHz) as USART clock source
+            RCC->CCIPR &= ~RCC_CCIPR_USART2SEL;
+            RCC->CCIPR |= _VAL2FLD(RCC_CCIPR_USART2SEL, clock); // Kernel clock
 
             // Configure pin modes as ALT function
             pinMode(PA2, GPIO_ALT); // TX
@@ -50,19 +86,45 @@ USART_TypeDef * initUSART(int USART_ID, int baud_rate) {
             // Configure correct alternate functions
             GPIOA->AFR[0] |= (0b111 << GPIO_AFRL_AFSEL2_Pos);   //AF7
             GPIOA->AFR[1] |= (0b011 << GPIO_AFRH_AFSEL15_Pos);  //AF3
+
+            if (flow == USART_FLOW_RTS_CTS) {
+                GPIOA->AFR[0] |= (0b111 << GPIO_AFRL_AFSEL0_Pos) | (0b111 << GPIO_AFRL_AFSEL1_Pos);
+                pinMode(PA0, GPIO_ALT); // CTS
+                pinMode(PA1, GPIO_ALT); // RTS
+            }
             break;
     }
 
+    USART->CR1 &= ~USART_CR1_UE; // BRR and OVER8 can only be written while disabled
+
     // Set M = 00
     USART->CR1 &= ~(USART_CR1_M0 | USART_CR1_M1);    // M=00 corresponds to 1 start bit, 8 data bits, n stop bits
-    USART->CR1 &= ~USART_CR1_OVER8; // Set to 16 times sampling freq
     USART->CR2 &= ~USART_CR2_STOP;  // 0b00 corresponds to 1 stop bit
 
-    // Set baud rate to 115200 (see RM 38.5.4 for details)
-    // Tx/Rx baud = f_CK/USARTDIV (since oversampling by 16)
-    // f_CK = 16 MHz (HSI)
-
-    USART->BRR = (uint16_t) (HSI_FREQ / baud_rate);
+    // Hardware flow control
+    if (flow == USART_FLOW_RTS_CTS)
+        USART->CR3 |= USART_CR3_RTSE | USART_CR3_CTSE;
+    else
+        USART->CR3 &= ~(USART_CR3_RTSE | USART_CR3_CTSE);
+
+    // Baud rate (see RM 38.5.4 for details)
+    // 16x oversampling: baud = f_CK / USARTDIV, BRR = USARTDIV (at least 16)
+    // 8x oversampling:  baud = 2 * f_CK / USARTDIV, BRR = USARTDIV with bits 3:0 shifted right by one.
+    // Bit 0 of USARTDIV is dropped, so the step is the same f_CK / n either way; 8x only reaches further.
+    uint32_t f_ck = usartKernelClock(USART_ID, clock);
+    kernel_hz[USART_ID] = f_ck;
+    uint32_t div = (f_ck + baud_rate / 2) / baud_rate; // nearest f_CK / n
+
+    if (div >= 16) {
+        USART->CR1 &= ~USART_CR1_OVER8; // Set to 16 times sampling freq
+        USART->BRR = (uint16_t) div;
+    }
+    else {
+        if (div < 8)
+            div = 8; // fastest possible: f_CK / 8
+        USART->CR1 |= USART_CR1_OVER8; // Set to 8 times sampling freq
+        USART->BRR = (uint16_t) (((2 * div) & ~0xF) | (((2 * div) & 0xF) >> 1));
+    }
 
     USART->CR1 |= USART_CR1_UE;     // Enable USART
     USART->CR1 |= USART_CR1_TE | USART_CR1_RE; // Enable transmission and reception
@@ -70,6 +132,31 @@ USART_TypeDef * initUSART(int USART_ID, int baud_rate) {
     return USART;
 }
 
+/* Returns 1 if the peer is asserting CTS (ready for data); always 1 without flow control. */
+int usartClearToSend(USART_TypeDef * USART) {
+    if (!(USART->CR3 & USART_CR3_CTSE))
+        return 1;
+    return (USART->ISR & USART_ISR_CTS) != 0; // inverted copy of the nCTS pin
+}
+
+/* Returns the baud rate a USART actually runs at, from its kernel clock, BRR and OVER8. */
+uint32_t usartBaud(int USART_ID) {
+    USART_TypeDef * USART = id2Port(USART_ID);
+    uint32_t brr = USART->BRR;
+
+    if (USART->CR1 & USART_CR1_OVER8) {
+        uint32_t div8 = (brr & ~0xF) | ((brr & 0x7) << 1);
+        return (2 * kernel_hz[USART_ID] + div8 / 2) / div8;
+    }
+    return (kernel_hz[USART_ID] + brr / 2) / brr;
+}
+
+/* Returns how far the actual baud rate is from the one asked for, in parts per million (signed). Links
+ * start to fail somewhere past +-20000 ppm between the two ends combined. */
+int32_t usartBaudErrorPpm(int USART_ID, int baud_rate) {
+    return (int32_t) (((int64_t) usartBaud(USART_ID) - baud_rate) * 1000000 / baud_rate);
+}
+
 void sendChar(USART_TypeDef * USART, char data){
     while(!(USART->ISR & USART_ISR_TXE));
     USART->TDR = data;
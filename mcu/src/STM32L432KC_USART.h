@@ -11,12 +11,26 @@
 #define USART1_ID   1
 #define USART2_ID   2
 
+// Values which "clock" can take on in initUSARTClock() (USARTxSEL field of RCC_CCIPR)
+#define USART_CLK_PCLK   0b00 // APB clock: PCLK2 for USART1, PCLK1 for USART2 (80 MHz after configureClock())
+#define USART_CLK_SYSCLK 0b01
+#define USART_CLK_HSI16  0b10
+
+// Values which "flow" can take on in initUSARTClock()
+#define USART_FLOW_NONE    0
+#define USART_FLOW_RTS_CTS 1 // USART1: CTS PA11, RTS PA12; USART2: CTS PA0, RTS PA1 (all AF7)
+
 ///////////////////////////////////////////////////////////////////////////////
 // Function prototypes
 ///////////////////////////////////////////////////////////////////////////////
 
 USART_TypeDef * id2Port(int USART_ID);
 USART_TypeDef * initUSART(int USART_ID, int baud_rate);
+USART_TypeDef * initUSARTClock(int USART_ID, int baud_rate, int clock, int flow);
+int usartClearToSend(USART_TypeDef * USART);
+uint32_t usartKernelClock(int USART_ID, int clock);
+uint32_t usartBaud(int USART_ID);
+int32_t usartBaudErrorPpm(int USART_ID, int baud_rate);
 void sendChar(USART_TypeDef * USART, char data);
 char readChar(USART_TypeDef * USART);
 void sendString(USART_TypeDef * USART, char * charArray);
@@ -0,0 +1,83 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 22, 2025
+File function: Measures how much CPU is left over by counting idle-loop iterations. A baseline taken with
+nothing else running gives iterations per microsecond; over a rolling window, busy = 1 - (idle
+iterations counted) / (iterations an unloaded CPU would have managed in the same time). Anything that
+steals cycles from the idle loop (interrupt handlers, main loop work, printing) shows up as busy.
+The idle loop must be exactly the same code during calibration and use.
+*/
+
+#include "cpu_load.h"
+
+static uint32_t base_idle = 0;      // idle iterations counted during calibration
+static uint32_t base_elapsed = 0;   // over this many COUNT_TIM ticks
+static uint32_t idle[CPU_LOAD_WINDOW];
+static uint32_t elapsed[CPU_LOAD_WINDOW];
+static uint32_t idle_sum = 0;
+static uint32_t elapsed_sum = 0;
+static int next = 0;
+static void (*idle_hook)(void) = 0; // called once per idle iteration
+
+// Function cpuIdleMillis:
+// delay_millis() that counts how many times it polled the timer while waiting
+// Arguments: timer and delay as for delay_millis()
+// Returns: idle iterations
+__attribute__((noinline)) uint32_t cpuIdleMillis(TIM_TypeDef * TIMx, uint32_t ms) {
+    uint32_t count = 0;
+
+    TIMx->ARR = ms;     // Set timer max count
+    TIMx->EGR |= 1;     // Force update
+    TIMx->SR &= ~(0x1); // Clear UIF
+    TIMx->CNT = 0;      // Reset count
+
+    while (!(TIMx->SR & 1)) { // Wait for UIF to go high
+        if (idle_hook)
+            idle_hook();
+        count++;
+    }
+    return count;
+}
+
+// Function cpuLoadSetIdleHook:
+// Sets a function for cpuIdleMillis() to call every iteration. Set it before calibrating, so the
+// baseline includes the cost of calling it with nothing to do; whatever work it does later counts as busy.
+// Arguments: hook, or 0 for none
+void cpuLoadSetIdleHook(void (*hook)(void)) {
+    idle_hook = hook;
+}
+
+// Function cpuLoadCalibrate:
+// Sets the unloaded baseline
+// Arguments: idle iterations counted in elapsed ticks with nothing else running
+void cpuLoadCalibrate(uint32_t idle_count, uint32_t elapsed_ticks) {
+    base_idle = idle_count;
+    base_elapsed = elapsed_ticks;
+}
+
+// Function cpuLoadSample:
+// Adds one measurement to the rolling window, dropping the oldest
+// Arguments: idle iterations counted in elapsed ticks
+void cpuLoadSample(uint32_t idle_count, uint32_t elapsed_ticks) {
+    idle_sum += idle_count - idle[next];
+    elapsed_sum += elapsed_ticks - elapsed[next];
+    idle[next] = idle_count;
+    elapsed[next] = elapsed_ticks;
+    if (++next == CPU_LOAD_WINDOW)
+        next = 0;
+}
+
+// Function cpuLoadBusyPermille:
+// Returns: CPU busy over the rolling window in tenths of a percent (0 before calibration)
+uint32_t cpuLoadBusyPermille(void) {
+    if (base_idle == 0 || elapsed_sum == 0)
+        return 0;
+
+    // Idle iterations an unloaded CPU would have counted in elapsed_sum
+    uint64_t possible = (uint64_t) base_idle * elapsed_sum / base_elapsed;
+    if (possible == 0)
+        return 0;
+    uint64_t free_permille = (uint64_t) idle_sum * 1000 / possible;
+    return (free_permille >= 1000) ? 0 : (uint32_t)(1000 - free_permille);
+}
@@ -0,0 +1,27 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 22, 2025
+File function: Header for the idle-time CPU load meter shared by the interrupt and polling programs.
+*/
+
+#ifndef CPU_LOAD_H
+#define CPU_LOAD_H
+
+#include <stdint.h>
+#include <stm32l432xx.h>
+
+#define CPU_LOAD_WINDOW       100 // samples in the rolling window (SAMPLE_PERIOD_MS each: 1 s)
+#define CPU_LOAD_CALIBRATE_MS 100 // length of the unloaded baseline measurement
+
+///////////////////////////////////////////////////////////////////////////////
+// Function prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+uint32_t cpuIdleMillis(TIM_TypeDef * TIMx, uint32_t ms);
+void cpuLoadSetIdleHook(void (*hook)(void));
+void cpuLoadCalibrate(uint32_t idle, uint32_t elapsed);
+void cpuLoadSample(uint32_t idle, uint32_t elapsed);
+uint32_t cpuLoadBusyPermille(void);
+
+#endif // CPU_LOAD_H
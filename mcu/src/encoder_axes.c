@@ -0,0 +1,244 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 18, 2025
+File function: Configures any number of quadrature encoders on EXTI lines from a descriptor table, and
+decodes every encoder whose line is pending in one pass. An EXTI handler clears the pending lines it owns
+and hands them to encoderAxesDispatch(); axes whose lines aren't pending are skipped with one AND.
+Each axis is published with its own sequence counter, the same way as encoder_snapshot.c.
+Every axis also counts the ways edges get dropped as the edge rate climbs: illegal x4 transitions, pending
+flags that arrive with no pin change (the flag stood for a pulse that came and went), and lines that are
+pending again by the time the handler exits.
+*/
+
+#include "main.h"
+#include "encoder_axes.h"
+
+#define AXES_BARRIER() __asm volatile ("" ::: "memory")
+
+EncoderAxes encoder_axes;
+
+// Enables the NVIC vector that serves EXTI line n
+static void enableLineIRQ(int line) {
+    IRQn_Type irq;
+    if (line <= 4)
+        irq = (IRQn_Type)(EXTI0_IRQn + line); // lines 0-4 each have their own vector
+    else if (line <= 9)
+        irq = EXTI9_5_IRQn;
+    else
+        irq = EXTI15_10_IRQn;
+    NVIC->ISER[irq >> 5] |= (1 << (irq & 0x1F));
+}
+
+// Routes EXTI line gpioPinOffset(pin) to the pin's port and makes it interrupt on both edges,
+// or on rising edges only
+static void configureLine(int pin, int rising_only) {
+    int line = gpioPinOffset(pin);
+    uint32_t shift = 4 * (line % 4);
+
+    SYSCFG->EXTICR[line / 4] = (SYSCFG->EXTICR[line / 4] & ~(0xFu << shift)) |
+                               ((uint32_t) gpioPinToPort(pin) << shift);
+    EXTI->RTSR1 |= (1 << line);
+    if (rising_only)
+        EXTI->FTSR1 &= ~(1 << line);
+    else
+        EXTI->FTSR1 |= (1 << line);
+    enableLineIRQ(line);
+}
+
+// Pins still in their reset (analog) mode become pulled-up inputs. Pins another peripheral has
+// already claimed (TIM1 in hybrid mode) are left alone; the EXTI input sees them either way.
+static void configurePin(int pin) {
+    GPIO_TypeDef * port = gpioPinToBase(pin);
+    int offset = gpioPinOffset(pin);
+
+    gpioEnable(gpioPinToPort(pin));
+    if (((port->MODER >> (2 * offset)) & 0b11) == 0b11)
+        pinMode(pin, GPIO_INPUT);
+    pinResistor(pin, GPIO_PULL_UP);
+}
+
+// Function initEncoderAxes:
+// Configures pins and EXTI lines for every row of table and seeds each decoder from its pins.
+// Lines are unmasked last so no edge arrives before the state it is decoded against.
+// Arguments: table of count encoders, now is the current COUNT_TIM time
+// Returns: 0 on success, -1 if count is too large or two pins share an EXTI line
+int initEncoderAxes(const EncoderConfig * table, int count, uint32_t now) {
+    EncoderAxes * e = &encoder_axes;
+    uint32_t all = 0;
+
+    if (count < 0 || count > ENCODER_AXES_MAX)
+        return -1;
+    for (int i = 0; i < count; i++) {
+        uint32_t lines = 1u << gpioPinOffset(table[i].a_pin);
+        if (table[i].resolution == ENC_RES_X4)
+            lines |= 1u << gpioPinOffset(table[i].b_pin);
+        if ((all & lines) || gpioPinOffset(table[i].a_pin) == gpioPinOffset(table[i].b_pin))
+            return -1;
+        all |= lines;
+    }
+
+    RCC->APB2ENR |= RCC_APB2ENR_SYSCFGEN;
+
+    for (int i = 0; i < count; i++) {
+        configurePin(table[i].a_pin);
+        configurePin(table[i].b_pin);
+
+        e->a_port[i] = gpioPinToBase(table[i].a_pin);
+        e->b_port[i] = gpioPinToBase(table[i].b_pin);
+        e->a_bit[i] = (uint8_t) gpioPinOffset(table[i].a_pin);
+        e->b_bit[i] = (uint8_t) gpioPinOffset(table[i].b_pin);
+        e->resolution[i] = table[i].resolution;
+        e->ppr[i] = table[i].ppr;
+        e->lines[i] = 1u << e->a_bit[i];
+
+        configureLine(table[i].a_pin, table[i].resolution == ENC_RES_X1);
+        if (table[i].resolution == ENC_RES_X4) {
+            configureLine(table[i].b_pin, 0);
+            e->lines[i] |= 1u << e->b_bit[i];
+        }
+    }
+    e->count = count;
+    e->all_lines = all;
+
+    for (int i = 0; i < count; i++)
+        encoderAxisSeed(i, encoderAxisPins(i), 0, now);
+
+    EXTI->PR1 = all; // forget edges seen while configuring
+    EXTI->IMR1 |= all;
+    return 0;
+}
+
+// Function encoderAxisPins:
+// Returns: the current AB state of an axis (bit 1 = A, bit 0 = B)
+uint8_t encoderAxisPins(int axis) {
+    const EncoderAxes * e = &encoder_axes;
+    uint32_t idr = e->a_port[axis]->IDR;
+    uint32_t b_idr = (e->b_port[axis] == e->a_port[axis]) ? idr : e->b_port[axis]->IDR;
+    return (uint8_t)((((idr >> e->a_bit[axis]) & 1) << 1) | ((b_idr >> e->b_bit[axis]) & 1));
+}
+
+// Function encoderAxisSeed:
+// Restarts an axis' decoder from a known AB state and position (e.g. handed over by a hardware counter).
+// Must not be interrupted by the EXTI handler that serves the axis.
+// Arguments: axis number, ab state of the pins, position to continue from, now is the current time
+void encoderAxisSeed(int axis, uint8_t ab, quad_position_t position, uint32_t now) {
+    EncoderAxes * e = &encoder_axes;
+
+    e->sequence[axis]++;
+    AXES_BARRIER();
+    e->state[axis] = ab & 0b11;
+    e->direction[axis] = 0;
+    e->edge_index[axis] = 0;
+    e->position[axis] = position;
+    e->last_time[axis] = now;
+    e->edge_period[axis] = 0;
+    e->cycle_period[axis] = 0;
+    e->early[axis] = 0;
+    for (int k = 0; k < 4; k++)
+        e->edge_time[k][axis] = now;
+    AXES_BARRIER();
+    e->sequence[axis]++;
+}
+
+// Function encoderAxesDispatch:
+// Decodes every axis with a line in pending. Call from each EXTI handler that serves encoder lines,
+// after clearing the lines in EXTI->PR1. All such handlers must share one priority.
+// Arguments: pending EXTI lines, now is the COUNT_TIM time of the edge
+// Returns: bit i set if axis i counted an edge (direction[i] holds its step)
+uint32_t encoderAxesDispatch(uint32_t pending, uint32_t now) {
+    EncoderAxes * e = &encoder_axes;
+    uint32_t stepped = 0;
+
+    for (int i = 0; i < e->count; i++) {
+        if (!(pending & e->lines[i]))
+            continue;
+
+        uint8_t ab = encoderAxisPins(i);
+        uint8_t a = ab >> 1;
+        int step;
+
+        // A pending line whose pin is where we left it means its flag stood for two edges (or a
+        // glitch), unless the change was already decoded on an earlier pass through the other line
+        uint8_t changed = e->state[i] ^ ab;
+        uint32_t seen = pending & e->lines[i];
+        uint32_t moved = (((changed & 0b10) ? 1u << e->a_bit[i] : 0) |
+                          ((changed & 0b01) ? 1u << e->b_bit[i] : 0)) & e->lines[i];
+        if (e->resolution[i] == ENC_RES_X1)
+            moved = a ? seen : 0; // a rising edge must leave A high
+        uint32_t stale = seen & ~moved & ~e->early[i];
+        if (stale)
+            e->lost[i] += (stale & (stale - 1)) ? 2 : 1;
+        e->early[i] = (e->early[i] | moved) & ~seen;
+
+        switch (e->resolution[i]) {
+            case ENC_RES_X1: // A rose: forward if B is still low
+                step = a ? ((ab & 1) ? -1 : +1) : 0;
+                break;
+            case ENC_RES_X2: // A changed: forward if A and B now differ
+                step = (a != (e->state[i] >> 1)) ? ((a != (ab & 1)) ? +1 : -1) : 0;
+                break;
+            default:
+                step = quadStep(e->state[i], ab);
+                if (step == QUAD_ILLEGAL) {
+                    e->illegal[i]++;
+                    step = 0;
+                }
+                break;
+        }
+        e->state[i] = ab;
+        if (step == 0)
+            continue;
+
+        e->sequence[i]++; // odd: update in progress
+        AXES_BARRIER();
+        e->position[i] += step;
+        e->direction[i] = (int8_t) step;
+
+        // edge_time[edge_index] holds the edge one slot (resolution edges) ago
+        uint8_t k = e->edge_index[i];
+        e->cycle_period[i] = now - e->edge_time[k][i];
+        e->edge_time[k][i] = now;
+        e->edge_index[i] = (uint8_t)((k + 1) & (e->resolution[i] - 1));
+
+        e->edge_period[i] = now - e->last_time[i];
+        e->last_time[i] = now;
+        AXES_BARRIER();
+        e->sequence[i]++; // even: consistent
+        stepped |= 1u << i;
+    }
+    return stepped;
+}
+
+// Function encoderAxesExit:
+// Counts axes whose lines were pended again while the handler ran. Call last thing in each EXTI
+// handler; a line that keeps re-pending means edges are arriving faster than they are serviced.
+// Arguments: serviced is the pending mask that was passed to encoderAxesDispatch()
+void encoderAxesExit(uint32_t serviced) {
+    EncoderAxes * e = &encoder_axes;
+    uint32_t again = EXTI->PR1 & EXTI->IMR1 & serviced;
+
+    if (again == 0)
+        return;
+    for (int i = 0; i < e->count; i++)
+        if (again & e->lines[i])
+            e->repended[i]++;
+}
+
+// Function encoderAxisRead:
+// Copies out a consistent sample of one axis, retrying if an edge interrupted the copy.
+// period is the time spanned by the last slot.
+// Arguments: axis number, sample receives the copy
+void encoderAxisRead(int axis, EncoderSample * sample) {
+    const EncoderAxes * e = &encoder_axes;
+    uint32_t start;
+    do {
+        start = e->sequence[axis];
+        AXES_BARRIER();
+        sample->timestamp = e->last_time[axis];
+        sample->period = e->cycle_period[axis];
+        sample->position = e->position[axis];
+        sample->direction = e->direction[axis];
+        AXES_BARRIER();
+    } while ((start & 1) || start != e->sequence[axis]);
+}
@@ -0,0 +1,78 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 18, 2025
+File function: Header for the table-driven multi-encoder EXTI front end. Each encoder is described by one
+EncoderConfig row; per-encoder state is kept as a struct of arrays so the interrupt dispatch walks
+small contiguous arrays instead of striding over whole per-encoder structs.
+*/
+
+#ifndef ENCODER_AXES_H
+#define ENCODER_AXES_H
+
+#include <stdint.h>
+#include "STM32L432KC_GPIO.h"
+#include "quad_decoder.h"
+#include "encoder_snapshot.h"
+
+#ifndef ENCODER_AXES_MAX
+#define ENCODER_AXES_MAX 4 // room reserved for this many encoders
+#endif
+
+// Values which "resolution" can take on (edges counted per slot)
+#define ENC_RES_X1 1 // rising edge of A only, one EXTI line
+#define ENC_RES_X2 2 // both edges of A, one EXTI line
+#define ENC_RES_X4 4 // both edges of A and B, two EXTI lines, illegal transitions detected
+
+// One encoder. Pins are GPIO pin IDs (e.g. PA6); every pin number must be unique across
+// the whole table since EXTI line n is shared by PAn, PBn and PCn.
+typedef struct {
+    uint8_t a_pin;
+    uint8_t b_pin;
+    uint16_t ppr;       // slots per revolution
+    uint8_t resolution; // ENC_RES_X1, ENC_RES_X2 or ENC_RES_X4
+} EncoderConfig;
+
+// Per-encoder state, indexed by axis number
+typedef struct {
+    // Touched by every edge
+    uint8_t state[ENCODER_AXES_MAX];       // last AB state seen
+    int8_t direction[ENCODER_AXES_MAX];    // +1 (CW) or -1 (CCW) of the last counted edge
+    uint8_t edge_index[ENCODER_AXES_MAX];  // next slot in edge_time
+    quad_position_t position[ENCODER_AXES_MAX]; // signed edge count at the axis' resolution
+    uint32_t last_time[ENCODER_AXES_MAX];  // COUNT_TIM time of the last counted edge
+    uint32_t edge_period[ENCODER_AXES_MAX]; // ticks between the last two counted edges
+    uint32_t cycle_period[ENCODER_AXES_MAX]; // ticks spanned by the last slot (resolution edges)
+    uint32_t edge_time[4][ENCODER_AXES_MAX]; // times of the last resolution edges
+    volatile uint32_t sequence[ENCODER_AXES_MAX]; // odd while the axis is being updated
+    uint32_t illegal[ENCODER_AXES_MAX];    // x4 transitions where A and B both changed
+    uint32_t lost[ENCODER_AXES_MAX];       // pending flags whose pin had not changed (two edges in one flag)
+    uint32_t repended[ENCODER_AXES_MAX];   // handler exits with one of the axis' lines pending again
+    uint32_t early[ENCODER_AXES_MAX];      // lines whose change was decoded before their flag was seen
+
+    // Set once by initEncoderAxes()
+    uint32_t lines[ENCODER_AXES_MAX];      // EXTI lines that belong to each axis
+    GPIO_TypeDef * a_port[ENCODER_AXES_MAX];
+    GPIO_TypeDef * b_port[ENCODER_AXES_MAX];
+    uint8_t a_bit[ENCODER_AXES_MAX];
+    uint8_t b_bit[ENCODER_AXES_MAX];
+    uint8_t resolution[ENCODER_AXES_MAX];
+    uint16_t ppr[ENCODER_AXES_MAX];
+    uint32_t all_lines;                    // union of lines[]
+    int count;
+} EncoderAxes;
+
+extern EncoderAxes encoder_axes;
+
+///////////////////////////////////////////////////////////////////////////////
+// Function prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+int initEncoderAxes(const EncoderConfig * table, int count, uint32_t now);
+uint32_t encoderAxesDispatch(uint32_t pending, uint32_t now);
+void encoderAxesExit(uint32_t serviced);
+uint8_t encoderAxisPins(int axis);
+void encoderAxisSeed(int axis, uint8_t ab, quad_position_t position, uint32_t now);
+void encoderAxisRead(int axis, EncoderSample * sample);
+
+#endif // ENCODER_AXES_H
@@ -0,0 +1,109 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 9, 2025
+File function: Routes the encoder A/B signals to COUNT_TIM input capture channels and lets DMA copy every
+capture into a circular RAM buffer. Timestamps are latched by the timer itself, so they carry no interrupt
+latency and cost no CPU per edge. The main loop drains merged, time-ordered edge events in batches.
+*/
+
+#include "main.h"
+#include "STM32L432KC_DMA.h"
+#include "encoder_capture.h"
+
+// DMA1 request mapping (RM 11.3.2): CH5 <- TIM2_CH1, CH7 <- TIM2_CH2, both on request 4
+#define CAP_DMA        DMA1
+#define CAP_A_DMA_CH   5
+#define CAP_B_DMA_CH   7
+#define CAP_DMA_REQ    4
+
+static uint32_t capture_a[CAPTURE_BUFFER_LEN]; // written by DMA from COUNT_TIM->CCR1
+static uint32_t capture_b[CAPTURE_BUFFER_LEN]; // written by DMA from COUNT_TIM->CCR2
+static uint32_t read_a = 0;  // next unread index in capture_a
+static uint32_t read_b = 0;  // next unread index in capture_b
+static uint8_t state = 0;    // encoder state after the last event handed out
+static uint8_t start_state = 0;
+static uint32_t overruns = 0; // captures the timer overwrote before DMA copied them out
+
+// Function initEncoderCapture:
+// Configures CAP_A_PIN/CAP_B_PIN as COUNT_TIM CH1/CH2 inputs capturing both edges,
+// and starts one circular DMA stream per channel. COUNT_TIM must already be running.
+// No arguments
+void initEncoderCapture(void) {
+    pinMode(CAP_A_PIN, GPIO_ALT);
+    pinMode(CAP_B_PIN, GPIO_ALT);
+    GPIOA->AFR[0] |= _VAL2FLD(GPIO_AFRL_AFSEL0, 1) | _VAL2FLD(GPIO_AFRL_AFSEL1, 1); // AF1 = TIM2_CH1/CH2
+    GPIOA->PUPDR |= (_VAL2FLD(GPIO_PUPDR_PUPD0, 0b01)); // PA0 pull-up
+    GPIOA->PUPDR |= (_VAL2FLD(GPIO_PUPDR_PUPD1, 0b01)); // PA1 pull-up
+
+    // Levels are tracked by toggling on each capture, so remember where we started
+    start_state = (uint8_t)((digitalRead(CAP_A_PIN) << 1) | digitalRead(CAP_B_PIN));
+    state = start_state;
+
+    initDMA(CAP_DMA, CAP_A_DMA_CH, CAP_DMA_REQ, DMA_PERIPH_TO_MEM, DMA_SIZE_32, DMA_CIRCULAR);
+    initDMA(CAP_DMA, CAP_B_DMA_CH, CAP_DMA_REQ, DMA_PERIPH_TO_MEM, DMA_SIZE_32, DMA_CIRCULAR);
+    startDMA(CAP_DMA, CAP_A_DMA_CH, &COUNT_TIM->CCR1, capture_a, CAPTURE_BUFFER_LEN);
+    startDMA(CAP_DMA, CAP_B_DMA_CH, &COUNT_TIM->CCR2, capture_b, CAPTURE_BUFFER_LEN);
+
+    initCaptureTIM(COUNT_TIM, 1, TIM_CAPTURE_BOTH);
+    initCaptureTIM(COUNT_TIM, 2, TIM_CAPTURE_BOTH);
+    COUNT_TIM->DIER |= TIM_DIER_CC1DE | TIM_DIER_CC2DE; // Capture events request DMA transfers
+}
+
+// Function readEdgeEvents:
+// Drains up to max captured edges from both channels, merged into time order
+// Must be called often enough that neither ring buffer wraps between calls
+// Arguments: events is filled with the edges, max is its length
+// Returns: number of events written
+int readEdgeEvents(EdgeEvent * events, int max) {
+    // Index DMA will write next = buffer length - transfers remaining
+    uint32_t write_a = CAPTURE_BUFFER_LEN - dmaRemaining(CAP_DMA, CAP_A_DMA_CH);
+    uint32_t write_b = CAPTURE_BUFFER_LEN - dmaRemaining(CAP_DMA, CAP_B_DMA_CH);
+    if (write_a == CAPTURE_BUFFER_LEN) write_a = 0;
+    if (write_b == CAPTURE_BUFFER_LEN) write_b = 0;
+
+    int n = 0;
+    while (n < max && (read_a != write_a || read_b != write_b)) {
+        int take_a;
+        if (read_a == write_a)
+            take_a = 0;
+        else if (read_b == write_b)
+            take_a = 1;
+        else
+            take_a = (int32_t)(capture_a[read_a] - capture_b[read_b]) <= 0; // wrap-safe compare
+
+        if (take_a) {
+            events[n].time = capture_a[read_a];
+            state ^= 0b10; // A toggled
+            read_a = (read_a + 1) % CAPTURE_BUFFER_LEN;
+        }
+        else {
+            events[n].time = capture_b[read_b];
+            state ^= 0b01; // B toggled
+            read_b = (read_b + 1) % CAPTURE_BUFFER_LEN;
+        }
+        events[n].ab = state;
+        n++;
+    }
+    return n;
+}
+
+// Function captureOverruns:
+// Collects the COUNT_TIM overcapture flags. A capture overwritten before DMA copied it is an edge
+// missing from the ring, so the toggled A/B state is out of step from then on and the decoder starts
+// counting illegal transitions. Call at least once per sample period.
+// Returns: total overcaptures on both channels so far
+uint32_t captureOverruns(void) {
+    uint32_t sr = COUNT_TIM->SR & (TIM_SR_CC1OF | TIM_SR_CC2OF);
+    if (sr & TIM_SR_CC1OF)
+        overruns++;
+    if (sr & TIM_SR_CC2OF)
+        overruns++;
+    COUNT_TIM->SR = ~sr; // rc_w0: only the flags just counted are cleared
+    return overruns;
+}
+
+// Returns the encoder state sampled before capture started
+uint8_t captureStartState(void) {
+    return start_state;
+}
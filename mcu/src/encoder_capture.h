@@ -0,0 +1,30 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 9, 2025
+File function: Header for the input capture + DMA edge timestamp path.
+*/
+
+#ifndef ENCODER_CAPTURE_H
+#define ENCODER_CAPTURE_H
+
+#include <stdint.h>
+
+#define CAPTURE_BUFFER_LEN 256 // timestamps per channel ring buffer
+
+// One encoder edge, as recorded by the timer at the moment the pin changed
+typedef struct {
+    uint32_t time; // COUNT_TIM capture value (us)
+    uint8_t ab;    // encoder state after the edge: bit 1 = A, bit 0 = B
+} EdgeEvent;
+
+///////////////////////////////////////////////////////////////////////////////
+// Function prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+void initEncoderCapture(void);
+int readEdgeEvents(EdgeEvent * events, int max);
+uint8_t captureStartState(void);
+uint32_t captureOverruns(void);
+
+#endif // ENCODER_CAPTURE_H
@@ -0,0 +1,77 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 9, 2025
+File function: Counts quadrature edges in the ENC_TIM encoder interface so no CPU time is spent per edge.
+The main loop samples the counter periodically and derives velocity and direction from the change in count.
+*/
+
+#include "main.h"
+#include "encoder_counter.h"
+
+#define COUNTER_WINDOW_US 100000 // velocity is averaged over at least this long (us)
+
+static uint16_t last_count = 0;   // raw 16 bit counter value at the previous sample
+static int32_t position = 0;      // counter extended to 32 bits (x4 edges)
+static int32_t window_position = 0; // position at the start of the velocity window
+static uint32_t window_start = 0;   // COUNT_TIM time at the start of the velocity window (us)
+static velocity_q_t velocity = 0; // revolutions per second (Q format)
+static uint32_t velocity_scale = 0;
+static int direction = 0;         // +1 or -1
+
+// Function initEncoderCounter:
+// Configures the encoder pins as TIM1 CH1/CH2 inputs with pull-ups and starts the encoder interface
+// Arguments: now is the current COUNT_TIM time (us)
+void initEncoderCounter(uint32_t now) {
+    RCC->APB2ENR |= RCC_APB2ENR_TIM1EN;
+
+    pinMode(ENC_TIM_A_PIN, GPIO_ALT);
+    pinMode(ENC_TIM_B_PIN, GPIO_ALT);
+    GPIOA->AFR[1] |= _VAL2FLD(GPIO_AFRH_AFSEL8, 1) | _VAL2FLD(GPIO_AFRH_AFSEL9, 1); // AF1 = TIM1_CH1/CH2
+    GPIOA->PUPDR |= (_VAL2FLD(GPIO_PUPDR_PUPD8, 0b01)); // PA8 pull-up
+    GPIOA->PUPDR |= (_VAL2FLD(GPIO_PUPDR_PUPD9, 0b01)); // PA9 pull-up
+
+    initEncoderTIM(ENC_TIM);
+
+    velocity_scale = velocityScale(COUNT_TIM_FREQ, ENCODER_PPR * 4); // x4 decoding
+    last_count = (uint16_t) ENC_TIM->CNT;
+    window_start = now;
+}
+
+// Function sampleEncoderCounter:
+// Reads the hardware counter and extends it to 32 bits, then updates velocity and direction
+// once per COUNTER_WINDOW_US. Must be called often enough that the counter moves less than
+// 32767 counts between calls.
+// Arguments: now is the current COUNT_TIM time (us)
+void sampleEncoderCounter(uint32_t now) {
+    uint16_t count = (uint16_t) ENC_TIM->CNT;
+    position += (int16_t)(count - last_count); // wraps correctly in both directions
+    last_count = count;
+
+    uint32_t elapsed = now - window_start;
+    if (elapsed < COUNTER_WINDOW_US)
+        return;
+
+    int32_t delta = position - window_position;
+    window_position = position;
+    window_start = now;
+
+    if (delta > 0)
+        direction = +1;
+    else if (delta < 0)
+        direction = -1;
+
+    velocity = velocityFromSpan(velocity_scale, (uint32_t)(delta < 0 ? -delta : delta), elapsed);
+}
+
+int32_t encoderCounterPosition(void) {
+    return position;
+}
+
+velocity_q_t encoderCounterVelocity(void) {
+    return velocity;
+}
+
+int encoderCounterDirection(void) {
+    return direction;
+}
@@ -0,0 +1,24 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 9, 2025
+File function: Header for the hardware quadrature counter (timer encoder interface) measurement path.
+*/
+
+#ifndef ENCODER_COUNTER_H
+#define ENCODER_COUNTER_H
+
+#include <stdint.h>
+#include "velocity.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// Function prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+void initEncoderCounter(uint32_t now);
+void sampleEncoderCounter(uint32_t now);
+int32_t encoderCounterPosition(void);
+velocity_q_t encoderCounterVelocity(void);
+int encoderCounterDirection(void);
+
+#endif // ENCODER_COUNTER_H
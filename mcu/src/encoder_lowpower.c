@@ -0,0 +1,170 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 19, 2025
+File function: Counts quadrature edges in LPTIM1 (clocked from LSI) while the core sits in Stop 2, where
+the PLL, TIM1/TIM2 and the EXTI path are all stopped. The core only wakes for the RTC report tick or when
+LPTIM1 sees the shaft move LOWPOWER_WAKE_COUNTS or change direction. Position is extended to 32 bits
+at every wake, and velocity uses the same fixed point engine as the active modes. The span is the RTC
+report period measured once against COUNT_TIM at startup, so LSI's +-5% tolerance doesn't reach the result.
+LPTIM1 needs a kernel clock of at least 4x the edge rate: with LSI that is ~8000 x4 edges/s.
+*/
+
+#include "main.h"
+#include "encoder_lowpower.h"
+#include "STM32L432KC_LPTIM.h"
+#include "STM32L432KC_RTC.h"
+
+#define LOWPOWER_REPORT_TICKS (LOWPOWER_REPORT_MS * RTC_WAKEUP_HZ / 1000) // RTC wakeup ticks per report
+
+static volatile int wake_reasons = 0; // LOWPOWER_WAKE_* bits set by the interrupt handlers
+static uint16_t last_count = 0;       // raw LPTIM1 count at the previous wake
+static int32_t position = 0;          // count extended to 32 bits (x4 edges)
+static int32_t report_position = 0;   // position at the previous report tick
+static velocity_q_t velocity = 0;
+static uint32_t velocity_scale = 0;
+static uint32_t report_us = 0;        // measured length of one report period (COUNT_TIM ticks)
+static int direction = 0;             // +1 or -1
+static volatile int turned = 0;       // direction LPTIM1 last reported changing to, 0 if unknown
+
+// Moves the threshold compare LOWPOWER_WAKE_COUNTS ahead of count in the current direction
+static void armThreshold(uint16_t count) {
+    int16_t step = (direction < 0) ? -LOWPOWER_WAKE_COUNTS : LOWPOWER_WAKE_COUNTS;
+    setCompareLPTIM(LPTIM1, (uint16_t)(count + step));
+}
+
+// Times one RTC report period with COUNT_TIM (interrupts not yet enabled, so poll WUTF)
+static uint32_t measureReportPeriod(void) {
+    clearRTCWakeup();
+    while (!(RTC->ISR & RTC_ISR_WUTF));
+    uint32_t start = COUNT_TIM->CNT;
+    clearRTCWakeup();
+    while (!(RTC->ISR & RTC_ISR_WUTF));
+    uint32_t period = COUNT_TIM->CNT - start;
+    clearRTCWakeup();
+    return period;
+}
+
+// Function initEncoderLowPower:
+// Starts LSI, LPTIM1 in encoder mode on PB5/PB7 and the RTC report tick, and routes both to
+// EXTI lines that can wake the core from Stop 2. COUNT_TIM must be running; it is used once to
+// calibrate the report period (takes two report periods).
+void initEncoderLowPower(void) {
+    enableLSI();
+
+    // LPTIM1_IN1 = PB5, LPTIM1_IN2 = PB7 (AF1) with pull-ups
+    gpioEnable(GPIO_PORT_B);
+    pinMode(LP_ENC_A_PIN, GPIO_ALT);
+    pinMode(LP_ENC_B_PIN, GPIO_ALT);
+    GPIOB->AFR[0] |= _VAL2FLD(GPIO_AFRL_AFSEL5, 1) | _VAL2FLD(GPIO_AFRL_AFSEL7, 1);
+    pinResistor(LP_ENC_A_PIN, GPIO_PULL_UP);
+    pinResistor(LP_ENC_B_PIN, GPIO_PULL_UP);
+
+    RCC->APB1ENR1 |= RCC_APB1ENR1_LPTIM1EN;
+    RCC->CCIPR = (RCC->CCIPR & ~RCC_CCIPR_LPTIM1SEL) | _VAL2FLD(RCC_CCIPR_LPTIM1SEL, 0b01); // LSI
+    initEncoderLPTIM(LPTIM1, LPTIM_IER_CMPMIE | LPTIM_IER_UPIE | LPTIM_IER_DOWNIE);
+
+    last_count = readLPTIM(LPTIM1);
+    velocity_scale = velocityScale(COUNT_TIM_FREQ, ENCODER_PPR * 4); // x4 decoding
+
+    initRTCWakeup(LOWPOWER_REPORT_TICKS);
+    report_us = measureReportPeriod();
+
+    // Catch up on anything that moved while calibrating
+    uint16_t count = readLPTIM(LPTIM1);
+    position += (int16_t)(count - last_count);
+    last_count = count;
+    report_position = position;
+    armThreshold(count);
+    LPTIM1->ICR = LPTIM_ICR_CMPMCF | LPTIM_ICR_UPCF | LPTIM_ICR_DOWNCF;
+
+    // LPTIM1 wakes through direct EXTI line 32, the RTC wakeup timer through EXTI line 20 (rising)
+    EXTI->IMR2 |= EXTI_IMR2_IM32;
+    EXTI->RTSR1 |= EXTI_RTSR1_RT20;
+    EXTI->IMR1 |= EXTI_IMR1_IM20;
+    NVIC->ISER[LPTIM1_IRQn >> 5] |= (1 << (LPTIM1_IRQn & 0x1F));
+    NVIC->ISER[RTC_WKUP_IRQn >> 5] |= (1 << (RTC_WKUP_IRQn & 0x1F));
+
+    // Stop 2 on deep sleep. Keep the debug clocks (and SWO printf) alive only if a debugger is attached.
+    PWR->CR1 = (PWR->CR1 & ~PWR_CR1_LPMS) | PWR_CR1_LPMS_STOP2;
+    if (CoreDebug->DHCSR & CoreDebug_DHCSR_C_DEBUGEN_Msk)
+        DBGMCU->CR |= DBGMCU_CR_DBG_STOP;
+}
+
+// Function encoderLowPowerSleep:
+// Enters Stop 2 until one of the wake sources fires, restores the 80 MHz clock and brings position
+// (and, on a report tick, velocity and direction) up to date
+// Returns: LOWPOWER_WAKE_* bits for everything that fired since the last call
+int encoderLowPowerSleep(void) {
+    int reasons;
+
+    __disable_irq();
+    while (wake_reasons == 0) {
+        SCB->SCR |= SCB_SCR_SLEEPDEEP_Msk;
+        __WFI(); // a pending interrupt wakes the core even with PRIMASK set
+        SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+        if ((RCC->CFGR & RCC_CFGR_SWS) != RCC_CFGR_SWS_PLL)
+            configureClock(); // Stop 2 wakes up on MSI
+        __enable_irq(); // run the handler that woke us
+        __disable_irq();
+    }
+    reasons = wake_reasons;
+    wake_reasons = 0;
+    __enable_irq();
+
+    // Never more than LOWPOWER_WAKE_COUNTS (< 32768) edges between wakes, so int16 wraps correctly
+    uint16_t count = readLPTIM(LPTIM1);
+    position += (int16_t)(count - last_count);
+    last_count = count;
+
+    if (reasons & LOWPOWER_WAKE_REPORT) {
+        int32_t delta = position - report_position;
+        report_position = position;
+        if (delta > 0)
+            direction = +1;
+        else if (delta < 0)
+            direction = -1;
+        velocity = velocityFromSpan(velocity_scale, (uint32_t)(delta < 0 ? -delta : delta), report_us);
+    }
+    if ((reasons & LOWPOWER_WAKE_DIRECTION) && turned != 0)
+        direction = turned;
+
+    armThreshold(count);
+    return reasons;
+}
+
+// Function encoderLowPowerCountIRQ:
+// Call from LPTIM1_IRQHandler. Only records why the core woke; the work happens in encoderLowPowerSleep().
+void encoderLowPowerCountIRQ(void) {
+    uint32_t flags = LPTIM1->ISR & (LPTIM_ISR_CMPM | LPTIM_ISR_UP | LPTIM_ISR_DOWN);
+    LPTIM1->ICR = flags & (LPTIM_ICR_CMPMCF | LPTIM_ICR_UPCF | LPTIM_ICR_DOWNCF);
+
+    if (flags & LPTIM_ISR_CMPM)
+        wake_reasons |= LOWPOWER_WAKE_THRESHOLD;
+    if (flags & (LPTIM_ISR_UP | LPTIM_ISR_DOWN)) {
+        wake_reasons |= LOWPOWER_WAKE_DIRECTION;
+        // Both flags means it turned more than once: leave it to the next report's position change
+        turned = ((flags & LPTIM_ISR_UP) && (flags & LPTIM_ISR_DOWN)) ? 0 :
+                 (flags & LPTIM_ISR_DOWN) ? -1 : +1;
+    }
+}
+
+// Function encoderLowPowerTickIRQ:
+// Call from RTC_WKUP_IRQHandler
+void encoderLowPowerTickIRQ(void) {
+    clearRTCWakeup();
+    EXTI->PR1 = EXTI_PR1_PIF20;
+    wake_reasons |= LOWPOWER_WAKE_REPORT;
+}
+
+int32_t encoderLowPowerPosition(void) {
+    return position;
+}
+
+velocity_q_t encoderLowPowerVelocity(void) {
+    return velocity;
+}
+
+int encoderLowPowerDirection(void) {
+    return direction;
+}
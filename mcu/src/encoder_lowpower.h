@@ -0,0 +1,31 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 19, 2025
+File function: Header for the ultra-low-power measurement path (LPTIM1 encoder counting in Stop 2).
+*/
+
+#ifndef ENCODER_LOWPOWER_H
+#define ENCODER_LOWPOWER_H
+
+#include <stdint.h>
+#include "velocity.h"
+
+// Bits returned by encoderLowPowerSleep(): what woke the core
+#define LOWPOWER_WAKE_REPORT    0b001 // RTC report tick: position and velocity were updated
+#define LOWPOWER_WAKE_THRESHOLD 0b010 // shaft moved LOWPOWER_WAKE_COUNTS since the last wake
+#define LOWPOWER_WAKE_DIRECTION 0b100 // LPTIM1 changed counting direction
+
+///////////////////////////////////////////////////////////////////////////////
+// Function prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+void initEncoderLowPower(void);
+int encoderLowPowerSleep(void);
+void encoderLowPowerCountIRQ(void);
+void encoderLowPowerTickIRQ(void);
+int32_t encoderLowPowerPosition(void);
+velocity_q_t encoderLowPowerVelocity(void);
+int encoderLowPowerDirection(void);
+
+#endif // ENCODER_LOWPOWER_H
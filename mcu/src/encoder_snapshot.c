@@ -0,0 +1,39 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 12, 2025
+File function: Lock-free single-writer snapshot. The writer (an interrupt handler) bumps the sequence
+counter to odd, writes the sample, and bumps it back to even. Readers copy the sample and retry if the
+counter was odd or changed underneath them, so the writer never waits and interrupts are never disabled.
+*/
+
+#include "encoder_snapshot.h"
+
+// Keeps the compiler from moving sample accesses across sequence updates. On the single-core
+// Cortex-M4 the writer and reader share one memory view, so no hardware barrier is needed.
+#define SNAPSHOT_BARRIER() __asm volatile ("" ::: "memory")
+
+// Function snapshotPublish:
+// Writes a new sample. Only one context may publish to a given snapshot.
+// Arguments: snapshot to update, sample to copy in
+void snapshotPublish(EncoderSnapshot * snapshot, const EncoderSample * sample) {
+    snapshot->sequence++; // odd: update in progress
+    SNAPSHOT_BARRIER();
+    snapshot->sample = *sample;
+    SNAPSHOT_BARRIER();
+    snapshot->sequence++; // even: sample is consistent
+}
+
+// Function snapshotRead:
+// Copies out the latest consistent sample, retrying if the writer interrupted the copy.
+// Must not be called from a context that can preempt the writer (it would spin forever).
+// Arguments: snapshot to read, sample receives the copy
+void snapshotRead(const EncoderSnapshot * snapshot, EncoderSample * sample) {
+    uint32_t start;
+    do {
+        start = snapshot->sequence;
+        SNAPSHOT_BARRIER();
+        *sample = snapshot->sample;
+        SNAPSHOT_BARRIER();
+    } while ((start & 1) || start != snapshot->sequence);
+}
@@ -0,0 +1,36 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 12, 2025
+File function: Header for the sequence-counter (seqlock) snapshot that hands a consistent set of encoder
+values from the interrupt handler to the main loop without disabling interrupts.
+*/
+
+#ifndef ENCODER_SNAPSHOT_H
+#define ENCODER_SNAPSHOT_H
+
+#include <stdint.h>
+#include "quad_decoder.h"
+
+// Everything the main loop needs about the last counted edge, always from the same edge
+typedef struct {
+    uint32_t timestamp;       // COUNT_TIM time of the edge (us)
+    uint32_t period;          // ticks spanned by the last full quadrature cycle
+    quad_position_t position; // signed edge count, x4 resolution
+    int32_t direction;        // +1 (CW) or -1 (CCW)
+} EncoderSample;
+
+// sequence is odd while the writer is part way through an update
+typedef struct {
+    volatile uint32_t sequence;
+    EncoderSample sample;
+} EncoderSnapshot;
+
+///////////////////////////////////////////////////////////////////////////////
+// Function prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+void snapshotPublish(EncoderSnapshot * snapshot, const EncoderSample * sample);
+void snapshotRead(const EncoderSnapshot * snapshot, EncoderSample * sample);
+
+#endif // ENCODER_SNAPSHOT_H
@@ -0,0 +1,97 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 20, 2025
+File function: Tracks the encoder index pulse. The first index homes the position. After that the count
+between two indexes passed in the same direction is the true counts per revolution, and the time
+between them is one exact revolution, free of slot spacing errors. A count that disagrees with the
+configured PPR once is a slip and gets corrected; the same wrong count INDEX_PPR_CONFIRM times in a
+row means the configured PPR is wrong, and corrections stop so they don't make things worse.
+The index is normally gated to one A/B state, so it switches together with an A/B edge and may be
+seen just before or just after that edge is counted: INDEX_TOLERANCE counts of disagreement are
+expected and never corrected.
+*/
+
+#include "index_pulse.h"
+
+// Function indexInit:
+// Arguments: expected counts per revolution, mode is INDEX_CORRECT or INDEX_ZERO
+void indexInit(IndexTracker * index, uint32_t expected, int mode) {
+    index->offset = 0;
+    index->last_raw = 0;
+    index->last_time = 0;
+    index->expected = expected;
+    index->counts = 0;
+    index->revolution = 0;
+    index->mismatches = 0;
+    index->slip_total = 0;
+    index->slip = 0;
+    index->wrong_run = 0;
+    index->ppr_wrong = 0;
+    index->last_direction = 0;
+    index->homed = 0;
+    index->mode = (uint8_t) mode;
+}
+
+// Function indexPulse:
+// Handles one index pulse
+// Arguments: time of the index edge, raw decoder position at that edge, direction of travel
+// Returns: 1 if counts and revolution were updated from a full revolution
+int indexPulse(IndexTracker * index, uint32_t time, quad_position_t raw, int direction) {
+    int full = 0;
+
+    if (!index->homed) {
+        index->offset = raw;
+        index->homed = 1;
+    }
+    else if (direction == index->last_direction) {
+        quad_position_t turn = raw - index->last_raw;
+        uint32_t counts = (uint32_t)(turn < 0 ? -turn : turn);
+
+        if (counts != 0 && (turn > 0) == (direction > 0)) {
+            int32_t error = (int32_t) counts - (int32_t) index->expected;
+            if (error > INDEX_TOLERANCE || error < -INDEX_TOLERANCE) {
+                index->mismatches++;
+                index->wrong_run = (counts == index->counts && index->wrong_run < 255) ? index->wrong_run + 1 : 1;
+                if (index->wrong_run >= INDEX_PPR_CONFIRM)
+                    index->ppr_wrong = 1;
+            }
+            else {
+                index->wrong_run = 0;
+            }
+            index->counts = counts;
+            index->revolution = time - index->last_time;
+            full = 1;
+        }
+    }
+
+    index->last_raw = raw;
+    index->last_time = time;
+    index->last_direction = (int8_t) direction;
+
+    if (index->mode == INDEX_ZERO) {
+        index->offset = raw;
+        return full;
+    }
+
+    // The index must be a whole number of revolutions from home
+    int32_t expected = (int32_t) index->expected;
+    quad_position_t rel = raw - index->offset;
+    quad_position_t turns = (rel + (rel < 0 ? -expected : expected) / 2) / expected;
+    int32_t slip = (int32_t)(rel - turns * expected);
+
+    index->slip = 0;
+    if ((slip > INDEX_TOLERANCE || slip < -INDEX_TOLERANCE) && !index->ppr_wrong) {
+        index->offset += slip;
+        index->slip = slip;
+        index->slip_total += (uint32_t)(slip < 0 ? -slip : slip);
+    }
+    return full;
+}
+
+// Function indexAbsolute:
+// Arguments: raw decoder position
+// Returns: position relative to the home index
+quad_position_t indexAbsolute(const IndexTracker * index, quad_position_t raw) {
+    return raw - index->offset;
+}
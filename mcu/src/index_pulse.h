@@ -0,0 +1,48 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 20, 2025
+File function: Header for encoder index (Z) pulse tracking: homing, per-revolution position correction,
+counts-per-revolution measurement and revolution-exact timing.
+Nothing in here touches hardware so the same code builds on the host.
+*/
+
+#ifndef INDEX_PULSE_H
+#define INDEX_PULSE_H
+
+#include <stdint.h>
+#include "quad_decoder.h"
+
+#define INDEX_PPR_CONFIRM 3 // identical wrong counts in a row before the PPR itself is declared wrong
+#define INDEX_TOLERANCE   1 // counts of disagreement that are just the index racing the A/B edge it sits on
+
+// Values which "mode" can take on
+#define INDEX_CORRECT 0 // keep counting turns, pull the count back onto the index each revolution
+#define INDEX_ZERO    1 // position restarts at 0 on every index (angle within one turn)
+
+typedef struct {
+    quad_position_t offset;   // raw position of the index the absolute position is measured from
+    quad_position_t last_raw; // raw position at the previous index
+    uint32_t last_time;       // time of the previous index
+    uint32_t expected;        // counts per revolution from the configuration (ENCODER_PPR * 4)
+    uint32_t counts;          // counts in the last full revolution (0 until one is measured)
+    uint32_t revolution;      // time the last full revolution took (0 until one is measured)
+    uint32_t mismatches;      // revolutions whose count differed from expected
+    uint32_t slip_total;      // counts corrected since homing
+    int32_t slip;             // correction applied at the last index
+    uint8_t wrong_run;        // consecutive revolutions with the same wrong count
+    uint8_t ppr_wrong;        // set once expected is known to be wrong (corrections stop)
+    int8_t last_direction;
+    uint8_t homed;
+    uint8_t mode;
+} IndexTracker;
+
+///////////////////////////////////////////////////////////////////////////////
+// Function prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+void indexInit(IndexTracker * index, uint32_t expected, int mode);
+int indexPulse(IndexTracker * index, uint32_t time, quad_position_t raw, int direction);
+quad_position_t indexAbsolute(const IndexTracker * index, quad_position_t raw);
+
+#endif // INDEX_PULSE_H
@@ -0,0 +1,67 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 21, 2025
+File function: Storage, reset and printing for the interrupt statistics in isr_stats.h.
+*/
+
+#include <stdio.h>
+#include "isr_stats.h"
+
+static const char * const ISR_STAT_NAMES[ISR_STAT_COUNT] = {
+    "EXTI cycles",
+    "EXTI latency",
+    "TIM2 cycles",
+};
+
+IsrStat isr_stats[ISR_STAT_COUNT];
+
+// Function initIsrStats:
+// Starts the DWT cycle counter and clears every statistic
+void initIsrStats(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    isrStatsReset();
+}
+
+// Function isrStatsReset:
+// Clears every statistic
+void isrStatsReset(void) {
+    __disable_irq();
+    for (int i = 0; i < ISR_STAT_COUNT; i++) {
+        isr_stats[i].count = 0;
+        isr_stats[i].min = UINT32_MAX;
+        isr_stats[i].max = 0;
+        isr_stats[i].sum = 0;
+        for (int b = 0; b < ISR_HIST_BINS; b++)
+            isr_stats[i].hist[b] = 0;
+    }
+    __enable_irq();
+}
+
+// Function isrStatsDump:
+// Prints every statistic that has samples: count, min/mean/max in cycles and the non-empty
+// histogram bins. Each statistic is copied with interrupts off so its fields agree.
+void isrStatsDump(void) {
+    for (int i = 0; i < ISR_STAT_COUNT; i++) {
+        IsrStat s;
+        __disable_irq();
+        s = isr_stats[i];
+        __enable_irq();
+
+        if (s.count == 0)
+            continue;
+        printf("%s: n=%lu min=%lu mean=%lu max=%lu cycles\n", ISR_STAT_NAMES[i], (unsigned long)s.count,
+               (unsigned long)s.min, (unsigned long)(s.sum / s.count), (unsigned long)s.max);
+        for (int b = 0; b < ISR_HIST_BINS; b++) {
+            if (s.hist[b] == 0)
+                continue;
+            uint32_t low = b ? (1u << (b - 1)) : 0;
+            if (b == ISR_HIST_BINS - 1)
+                printf("  >= %5lu: %lu\n", (unsigned long)low, (unsigned long)s.hist[b]);
+            else
+                printf("  %5lu-%-5lu: %lu\n", (unsigned long)low, (unsigned long)(b ? (1u << b) - 1 : 0),
+                       (unsigned long)s.hist[b]);
+        }
+    }
+}
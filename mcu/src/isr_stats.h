@@ -0,0 +1,70 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 21, 2025
+File function: Header for interrupt cost and latency statistics. Samples are CPU cycles from the DWT cycle
+counter; each statistic keeps min/max/sum and a log2 histogram so one sample costs a few loads and stores,
+a CLZ and no divide. Build with ISR_STATS 0 to compile every probe out.
+*/
+
+#ifndef ISR_STATS_H
+#define ISR_STATS_H
+
+#include <stdint.h>
+#include <stm32l432xx.h>
+
+#ifndef ISR_STATS
+#define ISR_STATS 1
+#endif
+
+#define ISR_HIST_BINS 16 // bin 0 = 0 cycles, bin k = [2^(k-1), 2^k) cycles, last bin open ended
+
+// Statistics that are recorded (index into isr_stats)
+#define ISR_STAT_EXTI_CYCLES  0 // encoder EXTI handler, entry to exit
+#define ISR_STAT_EXTI_LATENCY 1 // A edge (TIM16 capture) to encoder EXTI handler entry
+#define ISR_STAT_TIM2_CYCLES  2 // COUNT_TIM handler (zero speed, index), entry to exit
+#define ISR_STAT_COUNT        3
+
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t hist[ISR_HIST_BINS];
+} IsrStat;
+
+extern IsrStat isr_stats[ISR_STAT_COUNT];
+
+// Adds one sample in cycles
+static inline void isrStatAdd(IsrStat * stat, uint32_t cycles) {
+    uint32_t bin = 32 - __CLZ(cycles);
+    if (bin >= ISR_HIST_BINS)
+        bin = ISR_HIST_BINS - 1;
+    stat->hist[bin]++;
+    stat->count++;
+    stat->sum += cycles;
+    if (cycles < stat->min)
+        stat->min = cycles;
+    if (cycles > stat->max)
+        stat->max = cycles;
+}
+
+#if ISR_STATS
+#define ISR_ENTER()   uint32_t isr_start_ = DWT->CYCCNT
+#define ISR_EXIT(id)  isrStatAdd(&isr_stats[id], DWT->CYCCNT - isr_start_)
+#define ISR_SAMPLE(id, cycles) isrStatAdd(&isr_stats[id], (cycles))
+#else
+#define ISR_ENTER()
+#define ISR_EXIT(id)
+#define ISR_SAMPLE(id, cycles)
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+// Function prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+void initIsrStats(void);
+void isrStatsReset(void);
+void isrStatsDump(void);
+
+#endif // ISR_STATS_H
@@ -5,21 +5,134 @@ Date: Oct. 6, 2025
 File function: This program uses an algorithm to sense quadrature encoder pulses and convert these into motor velocity and direction.
 */
 
+#include <string.h>
 #include "main.h"
+#include "encoder_counter.h"
+#include "encoder_capture.h"
+#include "velocity.h"
+#include "quad_decoder.h"
+#include "encoder_snapshot.h"
+#include "velocity_mt.h"
+#include "velocity_lsq.h"
+#include "slot_comp.h"
+#include "slot_store.h"
+#include "zero_speed.h"
+#include "encoder_axes.h"
+#include "encoder_lowpower.h"
+#include "index_pulse.h"
+#include "isr_stats.h"
+#include "cpu_load.h"
+#include "log_buffer.h"
+#include "telemetry.h"
+#include "usart_tx.h"
+#include "usart_rx.h"
+#include "log_rtt.h"
 
-#define A_PIN PA6 
+#if SLOT_COMP_EDGES != ENCODER_PPR * 4
+#error "SLOT_COMP_EDGES must match ENCODER_PPR with x4 decoding"
+#endif
+#if ENCODER_INDEX && (ENCODER_MODE == ENCODER_MODE_COUNTER || ENCODER_MODE == ENCODER_MODE_LOWPOWER)
+#error "ENCODER_INDEX needs a mode with per-edge positions (EXTI, capture or hybrid)"
+#endif
+#if VELOCITY_ESTIMATOR == VELOCITY_EST_INDEX && !ENCODER_INDEX
+#error "VELOCITY_EST_INDEX needs ENCODER_INDEX"
+#endif
+
+#if ENCODER_MODE == ENCODER_MODE_HYBRID
+#define A_PIN ENC_TIM_A_PIN // EXTI shares the pins with the TIM1 encoder interface
+#else
+#define A_PIN PA6
+#endif
 #define B_PIN PA9
 
-volatile uint32_t last_time = 0;
-volatile uint32_t current_time = 0; 
-volatile int direction = 0;   // +1 or -1
-volatile float velocity = 0;  // ticks per second
+#if SERIAL_USART == USART2_ID && ENCODER_MODE == ENCODER_MODE_CAPTURE
+#error "USART2 TX DMA (DMA1 channel 7) is taken by capture mode's TIM2_CH2 stream, use USART1"
+#elif SERIAL_USART == USART1_ID && ENCODER_MODE != ENCODER_MODE_CAPTURE
+#error "USART1 TX is PA9, the encoder B pin outside capture mode, use USART2"
+#endif
+#if (TELEMETRY && TELEMETRY_USART && !SERIAL_USART) || (LOG_OUTPUT == LOG_OUTPUT_USART && !SERIAL_USART)
+#error "telemetry or log output on the serial link, but SERIAL_USART is 0"
+#endif
+
+#if ISR_STATS && ENCODER_MODE == ENCODER_MODE_EXTI
+#define LATENCY_TIM TIM16 // captures A_PIN (PA6 = TIM16_CH1) at the CPU clock to time EXTI entry latency
+#endif
+
+// EXTI encoders: one row per axis, the first ENCODER_AXES rows are used. Axis 0 feeds the velocity
+// estimators and must stay x4; the others report position and slot period velocity.
+// No two rows may use the same pin number (PAn, PBn and PCn share EXTI line n), and none may use
+// LED_PIN or BUTTON_PIN. PA12 is USART1 RTS, which only capture mode (no EXTI axes) can enable.
+static const EncoderConfig encoder_table[] = {
+    { A_PIN, B_PIN, ENCODER_PPR, ENC_RES_X4 },
+    { PB0,   PB1,   ENCODER_PPR, ENC_RES_X4 },
+    { PB4,   PA12,  ENCODER_PPR, ENC_RES_X2 },
+    { PA7,   PB6,   ENCODER_PPR, ENC_RES_X1 },
+};
+
+#if ENCODER_AXES > ENCODER_AXES_MAX || ENCODER_AXES > 4
+#error "ENCODER_AXES is larger than encoder_table"
+#endif
+
+volatile int direction = 0;          // +1 or -1
+volatile velocity_q_t velocity = 0;  // revolutions per second (Q format, see velocity.h)
+
+static uint32_t velocity_scale = 0;  // reciprocal constant for the active measurement mode
+static uint32_t edge_scale = 0;      // reciprocal constant for a single x4 edge
+static QuadDecoder decoder;          // x4 decoder for capture mode (EXTI axes decode in encoder_axes.c)
+static EncoderSnapshot encoder_snapshot; // last edge, published by whoever runs the decoder
+static EncoderSample sample;         // main loop's consistent copy of encoder_snapshot
+static MtEstimator mt;               // M/T estimator state (VELOCITY_EST_MT)
+static LsqWindow lsq;                // least-squares window (VELOCITY_EST_LSQ)
+#if VELOCITY_ESTIMATOR == VELOCITY_EST_EDGE
+static SlotComp slot_comp;           // learned disk spacing correction
+static int slot_saved = 0;           // slot table written to flash this run
+#endif
+#if ENCODER_INDEX
+static IndexTracker index_tracker;      // homing, PPR check and revolution timing
+static EncoderSnapshot index_snapshot;  // last full revolution: period = its length, position = absolute
+#if ENCODER_MODE == ENCODER_MODE_CAPTURE
+static volatile uint32_t index_time = 0; // index edge waiting for the DMA edges around it
+static volatile int index_pending = 0;
+#endif
+#endif
+volatile int isr_stats_dump = 0;      // set from the debugger (or press the button) to print isr_stats
+#if ISR_STATS && VELOCITY_ESTIMATOR == VELOCITY_EST_LSQ
+volatile uint32_t lsq_cycles = 0;     // CPU cycles the last lsqAddEdge() took
+volatile uint32_t lsq_cycles_max = 0; // worst case since reset
+#endif
+static uint32_t axis_scale[ENCODER_AXES]; // reciprocal constant for each axis' slot period
+#if ENCODER_MODE == ENCODER_MODE_HYBRID
+static volatile int counting = 0;         // 1 while EXTI is masked and only TIM1 follows the shaft
+static volatile uint32_t isr_edges = 0;   // edges taken by EXTI9_5 since the main loop last looked
+static int32_t hybrid_position = 0;       // counter position at the previous rate check
+static uint32_t hybrid_time = 0;          // COUNT_TIM time of the previous rate check
+static uint32_t edge_mode_start = 0;      // COUNT_TIM time EXTI was last unmasked
+volatile uint32_t hybrid_switches = 0;    // mode changes since reset
+#endif
 
 // Function Prototypes
 void initTimer(void);
 void configureInterrupts(void);
-void updateVelocity(void);
-int _write(int file, char *ptr, int len);
+void serviceEncoderLines(uint32_t lines);
+void printAxes(uint32_t now);
+void printEdgeFaults(void);
+void processEdgeEvents(void);
+void addLsqEdge(uint32_t time, int direction);
+uint32_t edgePeriod(int step, uint32_t now, uint32_t cycle_period);
+void serviceSlotComp(void);
+void printVelocity(void);
+int32_t reportPosition(void);
+void sendTelemetry(uint32_t now);
+void serviceCommands(void);
+void initIndexPulse(void);
+void serviceIndex(void);
+void handleIndex(uint32_t time, quad_position_t raw, int direction);
+void printIndex(void);
+void initLatencyCapture(void);
+void runLowPower(void);
+int serviceHybrid(uint32_t now);
+void enterCounterMode(void);
+void enterEdgeMode(uint32_t now);
 
 // Main Function
 int main(void) {
@@ -32,12 +145,6 @@ int main(void) {
     // Enable GPIO ports
     gpioEnable(GPIO_PORT_A);
 
-    // Configure encoder pins as inputs with pull-ups
-    pinMode(A_PIN, GPIO_INPUT);
-    pinMode(B_PIN, GPIO_INPUT);
-    GPIOA->PUPDR |= (_VAL2FLD(GPIO_PUPDR_PUPD6, 0b01)); // PA6 pull-up
-    GPIOA->PUPDR |= (_VAL2FLD(GPIO_PUPDR_PUPD9, 0b01)); // PA9 pull-up
-
     // Initialize delay timer for printing values
     RCC->APB2ENR |= RCC_APB2ENR_TIM15EN;   
     initTIM(DELAY_TIM);
@@ -46,95 +153,763 @@ int main(void) {
     RCC->APB1ENR1 |= RCC_APB1ENR1_TIM2EN;
     initCounterTIM(COUNT_TIM);
 
+    // Interrupt cost and latency statistics, printed when the button (active low) is pressed.
+    // Also starts the DWT cycle counter used to time lsqAddEdge(). Before any encoder interrupt is
+    // unmasked, so the first ones are timed against a running counter and land in cleared statistics.
+    initIsrStats();
+
+    // Text output: RTT needs its control block in place even if it is only selected later
+    initLogRtt();
+
+#if SERIAL_USART
+    // Telemetry and text go out by DMA, double buffered; host commands come back the same way
+    initUsartTx(SERIAL_USART, SERIAL_BAUD, SERIAL_CLOCK, SERIAL_FLOW);
+    initUsartRx(SERIAL_USART);
+    printf("serial: USART%d at %lu baud (%ld ppm from %lu)\n", SERIAL_USART,
+           (unsigned long)usartBaud(SERIAL_USART), (long)usartBaudErrorPpm(SERIAL_USART, SERIAL_BAUD),
+           (unsigned long)SERIAL_BAUD);
+#endif
+
+#if ENCODER_MODE == ENCODER_MODE_LOWPOWER
+    // Edges are counted by LPTIM1 while the core sleeps; this never returns
+    runLowPower();
+#endif
+
+#if ENCODER_MODE == ENCODER_MODE_COUNTER
+    // Edges are counted by the ENC_TIM encoder interface, no interrupts needed
+    initEncoderCounter(COUNT_TIM->CNT);
+#elif ENCODER_MODE == ENCODER_MODE_CAPTURE
+    // Edges are timestamped by COUNT_TIM input capture and copied out by DMA
+    initEncoderCapture();
+    quadDecoderInit(&decoder, captureStartState(), COUNT_TIM->CNT);
+#elif ENCODER_MODE == ENCODER_MODE_HYBRID
+    // TIM1 counts every edge all the time, EXTI on the same pins adds per-edge timing at low speed.
+    // initEncoderCounter() sets up the pins (AF1 with pull-ups); the EXTI input still sees them.
+    initEncoderCounter(COUNT_TIM->CNT);
+    hybrid_time = COUNT_TIM->CNT;
+    configureInterrupts();
+#else
+    // Encoder pins become inputs with pull-ups, one EXTI line per counted input
     configureInterrupts();
+#endif
+
+#if ENCODER_MODE != ENCODER_MODE_COUNTER
+#if VELOCITY_ESTIMATOR == VELOCITY_EST_EDGE
+    // sample.period is a single (compensated) edge, in ticks with SLOT_PERIOD_Q fractional bits
+    velocity_scale = velocityScale(COUNT_TIM_FREQ, ENCODER_PPR * 4);
+#else
+    // sample.period spans four edges = one slot, M/T counts single edges
+    velocity_scale = velocityScale(COUNT_TIM_FREQ, ENCODER_PPR);
+#endif
+    edge_scale = velocityScale(COUNT_TIM_FREQ, ENCODER_PPR * 4);
+    mtInit(&mt, edge_scale, 0, COUNT_TIM->CNT);
+    lsqReset(&lsq);
+    initZeroSpeed(COUNT_TIM->CNT);
+    initIndexPulse();
+    initLatencyCapture();
+#endif
+
+    // Statistics button, active low
+    pinMode(BUTTON_PIN, GPIO_INPUT);
+    pinResistor(BUTTON_PIN, GPIO_PULL_UP);
+
+#if VELOCITY_ESTIMATOR == VELOCITY_EST_EDGE
+    slotCompInit(&slot_comp, slotStoreLoad() != 0, COUNT_TIM->CNT);
+#endif
+
+    // Unloaded baseline for the CPU load meter: the idle loop alone, with no interrupts.
+    // Log output is sent from the idle loop, so the hook goes in first and is part of the baseline.
+    // Startup text is flushed first so the baseline times an empty hook, not one still sending.
+    cpuLoadSetIdleHook(logPump);
+    logFlush();
+    __disable_irq();
+    uint32_t calibrate_start = COUNT_TIM->CNT;
+    uint32_t calibrate_idle = cpuIdleMillis(DELAY_TIM, CPU_LOAD_CALIBRATE_MS);
+    cpuLoadCalibrate(calibrate_idle, COUNT_TIM->CNT - calibrate_start);
 
     // enable interrupts globally
     __enable_irq();
 
+    uint32_t last_print = COUNT_TIM->CNT;
+    uint32_t last_sample = last_print;
+    int32_t print_position = 0;
+#if ENCODER_MODE != ENCODER_MODE_COUNTER
+    int was_stopped = 1;
+#endif
+    int button_was_up = 1;
+
     while (1) {
-        delay_millis(DELAY_TIM, 800);
+        // Wait out the sample period, counting idle iterations for the load meter
+        uint32_t idle = cpuIdleMillis(DELAY_TIM, SAMPLE_PERIOD_MS);
 
-        
-        volatile uint32_t now = TIM2->CNT;
+        volatile uint32_t now = COUNT_TIM->CNT;
+        cpuLoadSample(idle, now - last_sample);
+        last_sample = now;
         //printf("Current Time: %d \n", now);
-        if ((now - current_time) > 100000) { // if too long between interrupts then assume fully stopped
-            velocity = 0;
+
+        int button_up = digitalRead(BUTTON_PIN);
+        if ((button_was_up && !button_up) || isr_stats_dump) {
+            isrStatsDump();
+            isr_stats_dump = 0;
+        }
+        button_was_up = button_up;
+#if SERIAL_USART
+        serviceCommands();
+#endif
+
+#if ENCODER_MODE == ENCODER_MODE_COUNTER
+        sampleEncoderCounter(now);
+        velocity = encoderCounterVelocity();
+        direction = encoderCounterDirection();
+#else
+#if ENCODER_MODE == ENCODER_MODE_CAPTURE
+        processEdgeEvents();
+#endif
+#if VELOCITY_ESTIMATOR == VELOCITY_EST_LSQ
+        double fit_acceleration = 0;
+#endif
+#if ENCODER_MODE == ENCODER_MODE_HYBRID
+        // Fast shaft: EXTI is masked, the counter has the velocity
+        if (serviceHybrid(now)) {
+            velocity = encoderCounterVelocity();
+            direction = encoderCounterDirection();
+            was_stopped = 0;
+        }
+        else
+#endif
+        {
+            // Every field comes from the same edge even if the ISR fires during the copy
+            snapshotRead(&encoder_snapshot, &sample);
+            direction = sample.direction;
+#if VELOCITY_ESTIMATOR == VELOCITY_EST_MT
+            velocity = mtUpdate(&mt, &sample, now);
+#elif VELOCITY_ESTIMATOR == VELOCITY_EST_LSQ
+            LsqSums sums;
+            double fit_velocity;
+            lsqRead(&lsq, &sums);
+            if (lsqFit(&sums, COUNT_TIM_FREQ, ENCODER_PPR * 4, &fit_velocity, &fit_acceleration))
+                velocity = (velocity_q_t)((fit_velocity < 0 ? -fit_velocity : fit_velocity) * VELOCITY_ONE);
+            // Between edges the next period is at least the time already waited
+            velocity = velocityBound(velocity, edge_scale, now - sample.timestamp);
+            if (zeroSpeedStopped()) { // no edge within the timeout armed by the last one
+                velocity = 0;
+                fit_acceleration = 0;
+            }
+#elif VELOCITY_ESTIMATOR == VELOCITY_EST_INDEX
+            EncoderSample turn;
+            snapshotRead(&index_snapshot, &turn);
+            // One revolution's worth of single-edge counts: a per-revolution scale would not fit in 32 bits
+            velocity = velocityFromSpan(edge_scale, ENCODER_PPR * 4, turn.period);
+            // The turn in progress is at least as long as the time since its index
+            velocity = velocityBoundSpan(velocity, edge_scale, ENCODER_PPR * 4, now - turn.timestamp);
+#elif VELOCITY_ESTIMATOR == VELOCITY_EST_EDGE
+            // One edge over a fractional period: scale * 2^SLOT_PERIOD_Q / period, in 64 bits
+            velocity = velocityFromSpan(velocity_scale, 1u << SLOT_PERIOD_Q, sample.period);
+            velocity = velocityBound(velocity, edge_scale, now - sample.timestamp);
+            serviceSlotComp();
+#else
+            velocity = velocityFromPeriod(velocity_scale, sample.period);
+            // Between edges the next period is at least the time already waited
+            velocity = velocityBound(velocity, edge_scale, now - sample.timestamp);
+#endif
+            if (zeroSpeedStopped()) velocity = 0; // no edge within the timeout armed by the last one
+
+            // Report each stop once, with how long after the last edge it was detected
+            if (zeroSpeedStopped() && !was_stopped) {
+                printf("stopped %lu us after last edge (max %lu us, timeout ISR late by up to %lu us)\n",
+                       (unsigned long)zeroSpeedLatency(), (unsigned long)zeroSpeedLatencyMax(),
+                       (unsigned long)zeroSpeedLateMax());
+            }
+            was_stopped = zeroSpeedStopped();
+        }
+#endif
+
+#if TELEMETRY
+        // One binary record every sample replaces the text report below
+        sendTelemetry(now);
+        continue;
+#endif
+
+        if ((now - last_print) < PRINT_PERIOD_MS * 1000) // COUNT_TIM runs at 1 MHz
+            continue;
+        uint32_t print_elapsed = now - last_print;
+        last_print = now;
+
+        printVelocity();
+
+        // CPU busy over the last CPU_LOAD_WINDOW samples next to the x4 edge rate that caused it
+        int32_t position = reportPosition();
+        int32_t moved = position - print_position;
+        print_position = position;
+        uint32_t busy = cpuLoadBusyPermille();
+        printf("  cpu %lu.%lu%% busy, %lu edges/s\n", (unsigned long)(busy / 10), (unsigned long)(busy % 10),
+               (unsigned long)((uint64_t)(moved < 0 ? -moved : moved) * COUNT_TIM_FREQ / print_elapsed));
+#if VELOCITY_ESTIMATOR == VELOCITY_EST_LSQ && ENCODER_MODE != ENCODER_MODE_COUNTER
+#if ISR_STATS
+        printf("  accel %ld mHz/s, fit update %lu cycles/edge (max %lu)\n",
+               (long)(fit_acceleration * 1000), (unsigned long)lsq_cycles, (unsigned long)lsq_cycles_max);
+#else
+        printf("  accel %ld mHz/s\n", (long)(fit_acceleration * 1000));
+#endif
+#endif
+#if ENCODER_MODE == ENCODER_MODE_HYBRID
+        printf("  %s, %lu mode switches\n", counting ? "counter" : "per-edge", (unsigned long)hybrid_switches);
+#endif
+#if ENCODER_MODE == ENCODER_MODE_EXTI || ENCODER_MODE == ENCODER_MODE_HYBRID
+        printAxes(now);
+#endif
+        printEdgeFaults();
+#if ENCODER_INDEX
+        printIndex();
+#endif
+    }
+}
+
+// Prints velocity and direction in the same format for every measurement mode
+void printVelocity(void) {
+    int32_t milli = velocityMilli(velocity);
+    if (direction == 1){
+        printf("%ld.%03ld Hz CW\n", (long)(milli / 1000), (long)(milli % 1000));
+    }
+    else {
+        printf("%ld.%03ld Hz CCW\n", (long)(milli / 1000), (long)(milli % 1000));
+    }
+}
+
+// Returns: axis 0 position in x4 counts from whichever decoder is following the shaft
+int32_t reportPosition(void) {
+#if ENCODER_MODE == ENCODER_MODE_COUNTER
+    return encoderCounterPosition();
+#elif ENCODER_MODE == ENCODER_MODE_HYBRID
+    return counting ? encoderCounterPosition() : (int32_t) sample.position;
+#else
+    return (int32_t) sample.position;
+#endif
+}
+
+// Queues one telemetry record (telemetry.h) with the latest sample on the telemetry link. While the link
+// is backed up (CTS held off, or its queue filling faster than it drains) only one sample in every
+// "decimation" is sent, doubling each sample the pressure lasts; it halves again each time the link has
+// fully drained. Position and the error counters are running totals, so skipped samples lose resolution
+// in time only.
+void sendTelemetry(uint32_t now) {
+    static uint16_t sequence = 0;
+    static uint32_t dropped = 0;
+    static uint32_t decimated = 0;
+    static uint32_t decimation = 1;
+    static uint32_t skipped = 0;
+    TelemetryRecord record;
+    uint8_t frame[TELEMETRY_FRAME_MAX];
+
+#if TELEMETRY_USART
+    int backed_up = usartTxBackpressure();
+    int drained = usartTxIdle();
+#else
+    int backed_up = logFramesQueued() > LOG_FRAMES / 2;
+    int drained = logFramesQueued() == 0;
+#endif
+    if (backed_up && decimation < TELEMETRY_DECIMATION_MAX)
+        decimation *= 2;
+    else if (drained && decimation > 1)
+        decimation /= 2;
+    if (++skipped < decimation) {
+        decimated++;
+        return;
+    }
+    skipped = 0;
+
+    record.sequence = sequence++;
+    record.flags = (direction == 1) ? TELEMETRY_FLAG_CW : 0;
+#if ENCODER_MODE == ENCODER_MODE_COUNTER
+    record.flags |= TELEMETRY_FLAG_COUNTER;
+#elif ENCODER_MODE == ENCODER_MODE_HYBRID
+    // EXTI is masked while counting, so the zero-speed timeout expires even though the shaft is turning
+    if (counting)
+        record.flags |= TELEMETRY_FLAG_COUNTER;
+    else if (zeroSpeedStopped())
+        record.flags |= TELEMETRY_FLAG_STOPPED;
+#else
+    if (zeroSpeedStopped())
+        record.flags |= TELEMETRY_FLAG_STOPPED;
+#endif
+#if ENCODER_INDEX
+    if (index_tracker.homed)
+        record.flags |= TELEMETRY_FLAG_HOMED;
+#endif
+    record.timestamp = now;
+    record.position = reportPosition();
+    record.velocity = velocity;
+#if ENCODER_MODE == ENCODER_MODE_EXTI || ENCODER_MODE == ENCODER_MODE_HYBRID
+    record.illegal = (uint16_t) encoder_axes.illegal[0];
+    record.lost = (uint16_t) encoder_axes.lost[0];
+#elif ENCODER_MODE == ENCODER_MODE_CAPTURE
+    record.illegal = (uint16_t) decoder.illegal;
+    record.lost = (uint16_t) captureOverruns();
+#else
+    record.illegal = 0;
+    record.lost = 0;
+#endif
+    record.cpu_permille = (uint16_t) cpuLoadBusyPermille();
+    record.dropped = (uint16_t) dropped;
+    record.decimated = (uint16_t) decimated;
+
+    uint32_t len = telemetryFrame(&record, frame);
+#if TELEMETRY_USART
+    if (!usartTxWrite(frame, len))
+        dropped++;
+#else
+    if (!logFrame(frame, len))
+        dropped++;
+#endif
+}
+
+// Runs every host command received on the serial link since the last call. One idle-line frame is one
+// command; trailing CR/LF and spaces are ignored. Replies go to printf like every other text.
+void serviceCommands(void) {
+#if SERIAL_USART
+    static uint32_t reported = 0;
+    uint8_t command[32];
+    int len;
+
+    while ((len = usartRxFrame(command, sizeof(command) - 1)) != 0) {
+        if (len < 0)
+            continue; // damaged in reception, counted below
+        while (len > 0 && (command[len - 1] == '\r' || command[len - 1] == '\n' || command[len - 1] == ' '))
+            len--;
+        command[len] = 0;
+
+        if (strcmp((char *)command, "stats") == 0) {
+            isr_stats_dump = 1;
+        }
+        else if (strcmp((char *)command, "reset") == 0) {
+            isrStatsReset();
+            printf("command: statistics reset\n");
+        }
+        else if (strcmp((char *)command, "output itm") == 0) {
+            logSetOutput(LOG_OUTPUT_ITM);
+        }
+        else if (strcmp((char *)command, "output usart") == 0) {
+            logSetOutput(LOG_OUTPUT_USART);
         }
-        if (direction == 1){
-            printf("%.3f Hz CW\n", velocity);
+        else if (strcmp((char *)command, "output rtt") == 0) {
+            logSetOutput(LOG_OUTPUT_RTT);
         }
-        else {
-            printf("%.3f Hz CCW\n", velocity);
+        else if (len > 0) {
+            printf("command: unknown \"%s\" (stats, reset, output itm|usart|rtt)\n", (char *)command);
         }
     }
+
+    // Overruns can lose whole frames as well as bytes of one, so the count is the only full record
+    uint32_t lost = usartRxOverruns();
+    if (lost != reported) {
+        reported = lost;
+        printf("command: %lu lost\n", (unsigned long)lost);
+    }
+#endif
+}
+
+// Low-power main loop: sleeps in Stop 2 between RTC report ticks and LPTIM1 threshold wakes
+void runLowPower(void) {
+#if ENCODER_MODE == ENCODER_MODE_LOWPOWER
+    initEncoderLowPower();
+    __enable_irq();
+
+    while (1) {
+        logFlush(); // ITM stops with the core clock in Stop 2
+        if (!(encoderLowPowerSleep() & LOWPOWER_WAKE_REPORT))
+            continue; // threshold or direction wake: position is already up to date
+        velocity = encoderLowPowerVelocity();
+        direction = encoderLowPowerDirection();
+        printVelocity();
+    }
+#endif
 }
 
+// Sets up the pins, EXTI lines and NVIC vectors for every axis in encoder_table
 void configureInterrupts(void) {
-    RCC->APB2ENR |= RCC_APB2ENR_SYSCFGEN;
+    for (int i = 0; i < ENCODER_AXES; i++) {
+        const EncoderConfig * row = &encoder_table[i];
+        if (row->a_pin == LED_PIN || row->b_pin == LED_PIN ||
+            row->a_pin == BUTTON_PIN || row->b_pin == BUTTON_PIN) {
+            printf("encoder_table: axis %d uses the LED or button pin, encoders not configured\n", i);
+            return;
+        }
+    }
+    if (initEncoderAxes(encoder_table, ENCODER_AXES, COUNT_TIM->CNT) != 0)
+        printf("encoder_table: two axes share an EXTI line\n");
 
-    // Configure EXTI lines for PA6 and PA9
-    SYSCFG->EXTICR[1] |= _VAL2FLD(SYSCFG_EXTICR2_EXTI6, 0b000); // Select PA6
-    SYSCFG->EXTICR[2] |= _VAL2FLD(SYSCFG_EXTICR3_EXTI9, 0b000); // Select PA9
+    for (int i = 0; i < ENCODER_AXES; i++)
+        axis_scale[i] = velocityScale(COUNT_TIM_FREQ, encoder_table[i].ppr);
+}
+
+// Drains the edges captured since the last call through the decoder and publishes
+// the last one, exactly as the EXTI handler would have
+void processEdgeEvents(void) {
+    EdgeEvent events[32];
+    int n;
+    int edges = 0;
+    uint32_t period = 0;
 
-    // Unmask interrupts
-    EXTI->IMR1 |= (1 << 6) | (1 << 9);
+    while ((n = readEdgeEvents(events, 32)) > 0) {
+        for (int i = 0; i < n; i++) {
+#if ENCODER_INDEX && ENCODER_MODE == ENCODER_MODE_CAPTURE
+            // The index belongs to the position before the first edge that came after it
+            if (index_pending && (int32_t)(events[i].time - index_time) > 0) {
+                handleIndex(index_time, decoder.position, decoder.direction);
+                index_pending = 0;
+            }
+#endif
+            int step = quadDecoderUpdate(&decoder, events[i].ab, events[i].time);
+            if (step != 0) {
+                period = edgePeriod(step, events[i].time, decoder.cycle_period);
+                addLsqEdge(events[i].time, decoder.direction);
+                edges++;
+            }
+        }
+    }
 
-    // Trigger on both rising and falling edges for both pins
-    EXTI->RTSR1 |= (1 << 6) | (1 << 9); 
-    EXTI->FTSR1 |= (1 << 6) | (1 << 9);
+    captureOverruns();
 
-    // Enable EXTI lines in NVIC
-    NVIC->ISER[0] |= (1 << EXTI9_5_IRQn);
+    if (edges > 0) {
+        // Armed once per main loop pass: the window has to reach past the next pass plus one edge
+        uint32_t gap = (decoder.edge_period < ZERO_SPEED_MAX_US) ? decoder.edge_period : ZERO_SPEED_MAX_US;
+        zeroSpeedArmAtLeast(decoder.last_time, decoder.edge_period, SAMPLE_PERIOD_MS * 1000 + gap);
+        EncoderSample latest = { decoder.last_time, period, decoder.position, decoder.direction };
+        snapshotPublish(&encoder_snapshot, &latest);
+    }
 }
 
-// Reads timer to update velocity
-void updateVelocity(void) {
-    last_time = current_time; // save previous value
-    current_time = TIM2->CNT; // read current time
+// Services every encoder with a pending line among lines, then runs the estimator inputs for axis 0.
+// Only integer work here: the main loop turns periods into velocity with velocityFromPeriod() so the
+// ISRs never need FPU context stacking.
+void serviceEncoderLines(uint32_t lines) {
+    ISR_ENTER();
+#ifdef LATENCY_TIM
+    if (LATENCY_TIM->SR & TIM_SR_CC1IF) { // an A edge was captured
+        uint16_t entry = (uint16_t) LATENCY_TIM->CNT;
+        uint16_t edge = (uint16_t) LATENCY_TIM->CCR1; // reading CCR1 clears CC1IF
+        ISR_SAMPLE(ISR_STAT_EXTI_LATENCY, (uint16_t)(entry - edge));
+    }
+#endif
+    uint32_t pending = EXTI->PR1 & lines;
+    EXTI->PR1 = pending; // write 1 to clear: only the lines we are about to service
+
+    uint32_t now = COUNT_TIM->CNT;
+    uint32_t stepped = encoderAxesDispatch(pending, now);
 
-    // Compute velocity (ticks per second)
-    velocity = 1000000.0f / (float)(current_time - last_time) / 408.0f / 2.0f;  //  timer is at 1 MHz, divide by # of ticks, PPR, and # of edges 
+    if (stepped & 1) {
+        int step = encoder_axes.direction[0];
+        EncoderSample latest = { now, edgePeriod(step, now, encoder_axes.cycle_period[0]),
+                                 encoder_axes.position[0], step };
+        snapshotPublish(&encoder_snapshot, &latest);
+        addLsqEdge(now, step);
+        zeroSpeedArm(now, encoder_axes.edge_period[0]);
 
+#if ENCODER_MODE == ENCODER_MODE_HYBRID
+        // Hard cap on interrupt load if the shaft spins up faster than the main loop can react
+        if (++isr_edges > HYBRID_EDGE_BUDGET) {
+            logEvent("hybrid: %lu edges in one sample period, EXTI masked early\n", isr_edges, 0, 0, 0);
+            enterCounterMode();
+        }
+#endif
+    }
+    encoderAxesExit(pending);
+    ISR_EXIT(ISR_STAT_EXTI_CYCLES);
 }
 
-// Interrupt handler (same handler for both pin a6 and a9)
-// Triggers: Rising and Falling Edges of Both pins a6 and pins a9
-// Effects: changes the velocity and direction variables (velocity variabled changed through sub function updateVelocity)
-void EXTI9_5_IRQHandler(void) {
-    if (EXTI->PR1 & (1 << 6)) {
-        EXTI->PR1 |= (1 << 6); // clear pending
-        
-        updateVelocity();
+// Interrupt handlers for encoder EXTI lines. All run at the same priority; each one only looks at
+// the lines it serves, so an axis on any pin number works.
+// Triggers: the edges selected by encoder_table on each line
+// Effects: see serviceEncoderLines()
+void EXTI0_IRQHandler(void)     { serviceEncoderLines(EXTI_PR1_PIF0); }
+void EXTI1_IRQHandler(void)     { serviceEncoderLines(EXTI_PR1_PIF1); }
+void EXTI2_IRQHandler(void)     { serviceEncoderLines(EXTI_PR1_PIF2); }
+void EXTI3_IRQHandler(void)     { serviceEncoderLines(EXTI_PR1_PIF3); }
+void EXTI4_IRQHandler(void)     { serviceEncoderLines(EXTI_PR1_PIF4); }
+void EXTI9_5_IRQHandler(void)   { serviceEncoderLines(0x000003E0); } // lines 5-9
+void EXTI15_10_IRQHandler(void) { serviceEncoderLines(0x0000FC00); } // lines 10-15
+
+// Interrupt handler for COUNT_TIM (same priority as EXTI9_5 so the two never preempt each other)
+// Triggers: CH3 compare match = no encoder edge within the zero-speed timeout
+// Effects: marks the shaft stopped (read by the main loop through zeroSpeedStopped())
+void TIM2_IRQHandler(void) {
+    ISR_ENTER();
+    zeroSpeedService();
+    serviceIndex();
+    ISR_EXIT(ISR_STAT_TIM2_CYCLES);
+}
 
-        int a = digitalRead(A_PIN);
-        int b = digitalRead(B_PIN);
+// Timestamps every A edge at the CPU clock (TIM16 runs at 80 MHz with no prescaler) so the EXTI
+// handler can see how many cycles passed before it started. The pin stays on EXTI as well.
+void initLatencyCapture(void) {
+#ifdef LATENCY_TIM
+    RCC->APB2ENR |= RCC_APB2ENR_TIM16EN;
+    pinMode(A_PIN, GPIO_ALT);
+    GPIOA->AFR[0] |= _VAL2FLD(GPIO_AFRL_AFSEL6, 14); // AF14 = TIM16_CH1
 
-        if (a == b)
-            direction = -1;  // reverse
-        else
-            direction = +1;  // forward
+    LATENCY_TIM->PSC = 0;
+    LATENCY_TIM->ARR = 0xFFFF;
+    initCaptureTIM(LATENCY_TIM, 1, TIM_CAPTURE_BOTH);
+    LATENCY_TIM->CCMR1 &= ~TIM_CCMR1_IC1F; // no input filter: it would hide 8 cycles of latency
+    LATENCY_TIM->EGR |= 1;
+    LATENCY_TIM->CR1 |= TIM_CR1_CEN;
+#endif
+}
+
+// Captures the rising edge of the index pulse on COUNT_TIM CH4
+void initIndexPulse(void) {
+#if ENCODER_INDEX
+    pinMode(INDEX_PIN, GPIO_ALT);
+    GPIOA->AFR[0] |= _VAL2FLD(GPIO_AFRL_AFSEL3, 1); // AF1 = TIM2_CH4
+    pinResistor(INDEX_PIN, GPIO_PULL_UP);
+
+    indexInit(&index_tracker, ENCODER_PPR * 4, INDEX_MODE);
+
+    initCaptureTIM(COUNT_TIM, 4, TIM_CAPTURE_RISING);
+    COUNT_TIM->SR = (uint32_t)~TIM_SR_CC4IF;
+    COUNT_TIM->DIER |= TIM_DIER_CC4IE;
+    NVIC->ISER[0] |= (1 << TIM2_IRQn);
+#endif
+}
+
+// Called from TIM2_IRQHandler: pairs the captured index time with the position at that time
+void serviceIndex(void) {
+#if ENCODER_INDEX
+    if (!(COUNT_TIM->SR & TIM_SR_CC4IF))
+        return;
+    uint32_t time = COUNT_TIM->CCR4; // reading CCR4 clears CC4IF
+
+#if ENCODER_MODE == ENCODER_MODE_CAPTURE
+    // Edges are still sitting in the DMA buffers: processEdgeEvents() finds the position
+    index_time = time;
+    index_pending = 1;
+#else
+#if ENCODER_MODE == ENCODER_MODE_HYBRID
+    if (counting)
+        return; // EXTI is masked, axis 0's position is only brought up to date at the handoff
+#endif
+    // EXTI handlers share this priority, so every edge up to now is counted. One counted after
+    // the index belongs to the next position.
+    quad_position_t raw = encoder_axes.position[0];
+    if ((int32_t)(encoder_axes.last_time[0] - time) > 0)
+        raw -= encoder_axes.direction[0];
+    handleIndex(time, raw, encoder_axes.direction[0]);
+#endif
+#endif
+}
+
+// Feeds one index to the tracker and publishes each completed revolution
+void handleIndex(uint32_t time, quad_position_t raw, int direction) {
+#if ENCODER_INDEX
+    if (indexPulse(&index_tracker, time, raw, direction)) {
+        EncoderSample turn = { time, index_tracker.revolution, indexAbsolute(&index_tracker, raw), direction };
+        snapshotPublish(&index_snapshot, &turn);
     }
+#else
+    (void) time;
+    (void) raw;
+    (void) direction;
+#endif
+}
 
-    if (EXTI->PR1 & (1 << 9)) {
-        EXTI->PR1 |= (1 << 9); // clear pending
+// Prints homing state, absolute position and the measured counts per revolution
+void printIndex(void) {
+#if ENCODER_INDEX
+    if (!index_tracker.homed) {
+        printf("  index: not homed\n");
+        return;
+    }
+    printf("  index: position %ld, %lu counts/rev (expected %lu), %lu counts corrected%s\n",
+           (long)indexAbsolute(&index_tracker, sample.position), (unsigned long)index_tracker.counts,
+           (unsigned long)index_tracker.expected, (unsigned long)index_tracker.slip_total,
+           index_tracker.ppr_wrong ? ", ENCODER_PPR looks wrong" : "");
+#endif
+}
 
-        // updateVelocity(); removing for smoother output
+// Interrupt handlers for low-power mode (both can wake the core from Stop 2)
+// Triggers: LPTIM1 threshold compare or direction change / RTC wakeup timer
+// Effects: flag the wake reason for encoderLowPowerSleep()
+void LPTIM1_IRQHandler(void) {
+    encoderLowPowerCountIRQ();
+}
 
-        int a = digitalRead(A_PIN);
-        int b = digitalRead(B_PIN);
+void RTC_WKUP_IRQHandler(void) {
+    encoderLowPowerTickIRQ();
+}
 
-        if (a == b)
-            direction = +1;  // forward
-        else
-            direction = -1;  // reverse
+// Interrupt handler for the serial link's TX DMA channel
+// Triggers: transfer complete
+// Effects: starts the other buffer if frames were queued while this one was sent
+#if SERIAL_USART == USART1_ID
+void DMA2_Channel6_IRQHandler(void) {
+    usartTxComplete();
+}
+#elif SERIAL_USART == USART2_ID
+void DMA1_Channel7_IRQHandler(void) {
+    usartTxComplete();
+}
+#endif
+
+// Interrupt handlers for the serial link's receiver
+// Triggers: idle line after a burst of bytes / RX DMA half or full transfer
+// Effects: count the bytes DMA has copied into the ring, mark the end of a command at an idle line
+#if SERIAL_USART == USART1_ID
+void USART1_IRQHandler(void)        { usartRxIRQ(); }
+void DMA2_Channel7_IRQHandler(void) { usartRxIRQ(); }
+#elif SERIAL_USART == USART2_ID
+void USART2_IRQHandler(void)        { usartRxIRQ(); }
+void DMA1_Channel6_IRQHandler(void) { usartRxIRQ(); }
+#endif
+
+// Period published with each edge: the slot-compensated time since the previous edge, or the
+// time spanned by the last full quadrature cycle
+uint32_t edgePeriod(int step, uint32_t now, uint32_t cycle_period) {
+#if VELOCITY_ESTIMATOR == VELOCITY_EST_EDGE
+    (void) cycle_period;
+    return slotCompEdge(&slot_comp, step, now);
+#else
+    (void) step;
+    (void) now;
+    return cycle_period;
+#endif
+}
+
+// Learns from the edges measured since the last pass, lines up a slot table restored from flash once a
+// fresh revolution has been measured, and saves the learned table the first time the shaft stops after
+// every segment has been refined
+void serviceSlotComp(void) {
+#if VELOCITY_ESTIMATOR == VELOCITY_EST_EDGE
+    const uint16_t * stored = slotStoreLoad();
+
+    slotCompUpdate(&slot_comp);
+
+    if (slotCompAlignReady(&slot_comp) && stored != 0)
+        slotCompAlign(&slot_comp, stored);
+
+    // The zero-speed timeout, not velocity: that is only cleared for a stop after this runs
+    if (!slot_saved && zeroSpeedStopped() && slot_comp.mode == SLOT_LEARN &&
+        slot_comp.learned >= (uint32_t) SLOT_COMP_EDGES * SLOT_SAVE_PASSES) {
+        slotStoreSave(slot_comp.gain);
+        slot_saved = 1;
+    }
+#endif
+}
+
+#if ENCODER_MODE == ENCODER_MODE_HYBRID
+// Measures the edge rate from the TIM1 count once per main loop pass and switches between per-edge
+// interrupts and counter sampling with hysteresis (HYBRID_COUNTER_ABOVE / HYBRID_EDGE_BELOW)
+// Returns: 1 while velocity should come from the counter
+int serviceHybrid(uint32_t now) {
+    sampleEncoderCounter(now);
+    int32_t position = encoderCounterPosition();
+    int32_t delta = position - hybrid_position;
+    uint32_t elapsed = now - hybrid_time;
+    hybrid_position = position;
+    hybrid_time = now;
+    isr_edges = 0;
+
+    uint32_t rate = 0; // x4 edges per second
+    if (elapsed != 0)
+        rate = (uint32_t)((uint64_t)(delta < 0 ? -delta : delta) * COUNT_TIM_FREQ / elapsed);
+
+    if (!counting && rate > HYBRID_COUNTER_ABOVE)
+        enterCounterMode();
+    else if (counting && rate < HYBRID_EDGE_BELOW)
+        enterEdgeMode(now);
+
+    // The edge estimators need a moment to fill after EXTI comes back
+    return counting || (now - edge_mode_start) < HYBRID_SETTLE_US;
+}
+
+// Masks the encoder EXTI lines; TIM1 keeps counting so no position is lost.
+// Called from the main loop and from EXTI9_5_IRQHandler, so the update is done with interrupts off.
+void enterCounterMode(void) {
+    __disable_irq();
+    EXTI->IMR1 &= ~encoder_axes.lines[0];
+    counting = 1;
+    hybrid_switches++;
+    __enable_irq();
+}
+
+// Hands the position from the counter back to axis 0's decoder and unmasks its EXTI lines
+void enterEdgeMode(uint32_t now) {
+    int32_t position;
+    uint8_t ab;
+
+    __disable_irq();
+    // A/B state and count must describe the same instant: retry if an edge lands between the reads
+    do {
+        sampleEncoderCounter(now);
+        position = encoderCounterPosition();
+        ab = encoderAxisPins(0);
+        sampleEncoderCounter(now);
+    } while (encoderCounterPosition() != position);
+
+    encoderAxisSeed(0, ab, position, now);
+
+    // Restart everything that assumed it saw every edge, before the edge ISR that owns it can run
+    mtInit(&mt, edge_scale, position, now);
+    lsqReset(&lsq);
+#if VELOCITY_ESTIMATOR == VELOCITY_EST_EDGE
+    slotCompResync(&slot_comp, position, now);
+#endif
+    zeroSpeedArm(now, ZERO_SPEED_MAX_US);
+
+    EXTI->PR1 = encoder_axes.lines[0]; // drop edges latched while masked, the counter already has them
+    EXTI->IMR1 |= encoder_axes.lines[0];
+    counting = 0;
+    isr_edges = 0;
+    edge_mode_start = now;
+    hybrid_switches++;
+    __enable_irq();
+}
+#endif
+
+#if ENCODER_MODE == ENCODER_MODE_EXTI || ENCODER_MODE == ENCODER_MODE_HYBRID
+// Prints position and slot-period velocity of every axis after the first
+void printAxes(uint32_t now) {
+    for (int i = 1; i < ENCODER_AXES; i++) {
+        EncoderSample axis;
+        encoderAxisRead(i, &axis);
+
+        velocity_q_t v = velocityFromPeriod(axis_scale[i], axis.period);
+        v = velocityBound(v, axis_scale[i], now - axis.timestamp); // at most one slot since the last edge
+        if ((now - axis.timestamp) > ZERO_SPEED_MAX_US)
+            v = 0;
+        int32_t milli = velocityMilli(v);
+        printf("  axis %d: %ld counts, %ld.%03ld Hz %s\n", i, (long)axis.position,
+               (long)(milli / 1000), (long)(milli % 1000), axis.direction < 0 ? "CCW" : "CW");
     }
 }
+#endif
+
+// Prints the missed-edge counters of every per-edge decoder, so the edge rate above can be pushed
+// until they start to climb
+void printEdgeFaults(void) {
+#if ENCODER_MODE == ENCODER_MODE_EXTI || ENCODER_MODE == ENCODER_MODE_HYBRID
+    for (int i = 0; i < ENCODER_AXES; i++)
+        printf("  axis %d edges: %lu illegal, %lu lost, %lu re-pended\n", i, (unsigned long)encoder_axes.illegal[i],
+               (unsigned long)encoder_axes.lost[i], (unsigned long)encoder_axes.repended[i]);
+#elif ENCODER_MODE == ENCODER_MODE_CAPTURE
+    printf("  edges: %lu illegal, %lu overcaptured\n", (unsigned long)decoder.illegal,
+           (unsigned long)captureOverruns());
+#endif
+}
 
-// Function used by printf to send characters to the laptop (taken from E155 website)
-int _write(int file, char *ptr, int len) {
-  int i = 0;
-  for (i = 0; i < len; i++) {
-    ITM_SendChar((*ptr++));
-  }
-  return len;
+// Slides one edge into the least-squares window and, with ISR_STATS, records what it cost in CPU cycles
+void addLsqEdge(uint32_t time, int direction) {
+#if VELOCITY_ESTIMATOR == VELOCITY_EST_LSQ
+#if ISR_STATS
+    uint32_t start = DWT->CYCCNT;
+    lsqAddEdge(&lsq, time, direction);
+    lsq_cycles = DWT->CYCCNT - start;
+    if (lsq_cycles > lsq_cycles_max)
+        lsq_cycles_max = lsq_cycles;
+#else
+    lsqAddEdge(&lsq, time, direction);
+#endif
+#else
+    (void) time;
+    (void) direction;
+#endif
 }
@@ -6,18 +6,23 @@ File function: Polling version of quadrature encoder velocity and direction meas
 */
 
 #include "main.h"
+#include "velocity.h"
+#include "quad_decoder.h"
+#include "cpu_load.h"
+#include "log_buffer.h"
 
 #define A_PIN PA6 
 #define B_PIN PA9
+#define A_OFFSET (A_PIN & 0x0F) // bit of A_PIN in GPIOA->IDR
+#define B_OFFSET (B_PIN & 0x0F) // bit of B_PIN in GPIOA->IDR
 
 volatile uint32_t last_time = 0;
 volatile uint32_t current_time = 0; 
-volatile int direction = 0;   // +1 or -1
-volatile float velocity = 0;  // ticks per second
+volatile int direction = 0;          // +1 or -1
+volatile velocity_q_t velocity = 0;  // revolutions per second (Q format, see velocity.h)
 
 // Function Prototypes
 void initTimer(void);
-void updateVelocity(void);
 
 int main(void) {
 
@@ -43,32 +48,49 @@ int main(void) {
     RCC->APB1ENR1 |= RCC_APB1ENR1_TIM2EN;
     initCounterTIM(COUNT_TIM);
 
-    // Variables to track previous encoder state
-    int prev_a = digitalRead(A_PIN);
-    int prev_b = digitalRead(B_PIN);
+    // Same decoder and velocity scaling as lab5_main.c so the two programs are comparable
+    uint32_t velocity_scale = velocityScale(COUNT_TIM_FREQ, ENCODER_PPR); // cycle_period spans one slot
+    QuadDecoder decoder;
+    quadDecoderInit(&decoder, quadStateFromIDR(GPIOA->IDR, A_OFFSET, B_OFFSET), TIM2->CNT);
 
     uint32_t last_print_time = 0;
+    quad_position_t print_position = 0;
 
-    while (1) {
-        int cur_a = digitalRead(A_PIN);
-        int cur_b = digitalRead(B_PIN);
-
-        if ((cur_a != prev_a) || (cur_b != prev_b)) {
-            last_time = current_time;
-            current_time = TIM2->CNT;
+    // CPU load meter: a poll that finds nothing to do is idle. The first CPU_LOAD_CALIBRATE_MS of
+    // polling is the unloaded baseline (keep the shaft still at reset), then every SAMPLE_PERIOD_MS
+    // goes into the rolling window.
+    uint32_t idle = 0;
+    uint32_t sample_start = TIM2->CNT;
+    int calibrated = 0;
 
-            int delta = current_time - last_time;
-            if (delta > 0)
-                velocity = 1000000.0f / (float)delta / 408.0f / 4.0f;
-
-            // Direction logic
-            if (prev_a == prev_b)
-                direction = (cur_a == cur_b) ? -1 : +1;
-            else
-                direction = (cur_a == cur_b) ? +1 : -1;
+    while (1) {
+        uint8_t ab = quadStateFromIDR(GPIOA->IDR, A_OFFSET, B_OFFSET);
+
+        uint32_t sample_elapsed = TIM2->CNT - sample_start;
+        if (!calibrated && sample_elapsed >= CPU_LOAD_CALIBRATE_MS * 1000) {
+            cpuLoadCalibrate(idle, sample_elapsed);
+            calibrated = 1;
+            idle = 0;
+            sample_start += sample_elapsed;
+        }
+        else if (calibrated && sample_elapsed >= SAMPLE_PERIOD_MS * 1000) {
+            cpuLoadSample(idle, sample_elapsed);
+            idle = 0;
+            sample_start += sample_elapsed;
+        }
 
-            prev_a = cur_a;
-            prev_b = cur_b;
+        if (ab == decoder.state) {
+            idle++;
+            logPump(); // printf only queues the text
+        }
+        else {
+            uint32_t now = TIM2->CNT;
+            if (quadDecoderUpdate(&decoder, ab, now) != 0) {
+                last_time = current_time;
+                current_time = now;
+                velocity = velocityFromPeriod(velocity_scale, decoder.cycle_period);
+                direction = decoder.direction;
+            }
         }
 
         // Reset velocity if stopped
@@ -77,9 +99,19 @@ int main(void) {
 
         // Print only every 200 ms
         uint32_t now = TIM2->CNT;
-        if ((now - last_print_time) > 200000) { // 200 ms at 1 MHz timer
+        uint32_t print_elapsed = now - last_print_time;
+        if (print_elapsed > 200000) { // 200 ms at 1 MHz timer
             last_print_time = now;
-            printf("%.2f Hz %s\n", velocity, (direction == 1) ? "CW" : "CCW");
+            int32_t milli = velocityMilli(velocity);
+            printf("%ld.%03ld Hz %s\n", (long)(milli / 1000), (long)(milli % 1000), (direction == 1) ? "CW" : "CCW");
+
+            quad_position_t moved = decoder.position - print_position;
+            print_position = decoder.position;
+            uint32_t busy = cpuLoadBusyPermille();
+            // A slow printf makes the gap longer than 200 ms, so rate over the time that actually passed
+            uint64_t edges = (uint64_t)(moved < 0 ? -moved : moved);
+            printf("  cpu %lu.%lu%% busy, %lu edges/s\n", (unsigned long)(busy / 10), (unsigned long)(busy % 10),
+                   (unsigned long)(edges * COUNT_TIM_FREQ / print_elapsed));
         }
     }
 }
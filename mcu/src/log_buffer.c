@@ -0,0 +1,348 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 25, 2025
+File function: Non-blocking logger. logEvent() can be called from any context: it claims a record slot with
+LDREX/STREX on the head index, fills it, and marks it ready, so an interrupt that logs in the middle of
+another logEvent() just takes the next slot. Records are only formatted later, by logPump() in the idle
+loop, which also owns the text queue and is the only code that feeds the outputs. The worst case for a
+caller is a few retries of the claim loop, never a wait on the debugger or the link.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include "log_buffer.h"
+#include "log_rtt.h"
+#include "usart_tx.h"
+
+#define LOG_SLOT_MASK (LOG_SLOTS - 1)
+#define LOG_TEXT_MASK (LOG_TEXT_BYTES - 1)
+
+typedef struct {
+    const char * format;
+    uint32_t arg[4];
+    volatile uint32_t ready; // set by the producer once format and arg are written
+} LogRecord;
+
+static LogRecord records[LOG_SLOTS];
+static volatile uint32_t record_head = 0; // next slot to claim (any context)
+static volatile uint32_t record_tail = 0; // next slot to format (idle loop only)
+static volatile uint32_t dropped = 0;     // messages thrown away because a queue was full
+static uint32_t reported = 0;             // dropped count last written to the output
+
+volatile int log_output = LOG_OUTPUT; // where text goes (LOG_OUTPUT_*)
+
+// Text queue, main loop only: _write() and logPump() add, logPump() sends
+static char text[LOG_TEXT_BYTES];
+static uint32_t text_head = 0;
+static uint32_t text_tail = 0;
+
+// Frame queue, main loop only
+static uint8_t frames[LOG_FRAMES][LOG_FRAME_MAX];
+static uint32_t frame_len[LOG_FRAMES];
+static uint32_t frame_head = 0;
+static uint32_t frame_tail = 0;
+static uint32_t frame_sent = 0; // bytes of the oldest frame already sent
+
+// Counts one dropped message; safe against interrupts doing the same
+static void countDropped(void) {
+    uint32_t count;
+    do {
+        count = __LDREXW(&dropped) + 1;
+    } while (__STREXW(count, &dropped));
+}
+
+static uint32_t textFree(void) {
+    return LOG_TEXT_BYTES - (text_head - text_tail);
+}
+
+static void textPut(const char * s, uint32_t len) {
+    for (uint32_t i = 0; i < len; i++)
+        text[(text_head + i) & LOG_TEXT_MASK] = s[i];
+    text_head += len;
+}
+
+// Function logEvent:
+// Queues a message to be formatted later. Safe from interrupt handlers; never blocks.
+// Arguments: printf format (must stay valid, normally a string literal) taking up to four 32 bit
+// integer arguments (%lu, %ld, %lx); unused arguments are ignored
+void logEvent(const char * format, uint32_t a, uint32_t b, uint32_t c, uint32_t d) {
+    uint32_t slot;
+
+    do {
+        slot = __LDREXW(&record_head);
+        if (slot - record_tail >= LOG_SLOTS) {
+            __CLREX();
+            countDropped();
+            return;
+        }
+    } while (__STREXW(slot + 1, &record_head));
+
+    LogRecord * record = &records[slot & LOG_SLOT_MASK];
+    record->format = format;
+    record->arg[0] = a;
+    record->arg[1] = b;
+    record->arg[2] = c;
+    record->arg[3] = d;
+    __DMB(); // contents before the flag
+    record->ready = 1;
+}
+
+// Function logWrite:
+// Queues already formatted text (main loop only, used by _write). All or nothing: text that does not fit
+// is dropped as one message.
+// Returns: len, so printf never retries
+int logWrite(const char * s, int len) {
+    if (len <= 0)
+        return 0;
+    if ((uint32_t) len > textFree())
+        countDropped();
+    else
+        textPut(s, len);
+    return len;
+}
+
+// Function logFrame:
+// Queues one binary frame for LOG_FRAME_PORT (main loop only)
+// Returns: 1 if queued, 0 if the queue was full or the frame too long (the caller counts its own drops)
+int logFrame(const uint8_t * frame, uint32_t len) {
+    if (frame_head - frame_tail >= LOG_FRAMES || len > LOG_FRAME_MAX)
+        return 0;
+    uint32_t slot = frame_head & (LOG_FRAMES - 1);
+    for (uint32_t i = 0; i < len; i++)
+        frames[slot][i] = frame[i];
+    frame_len[slot] = len;
+    frame_head++;
+    return 1;
+}
+
+// Function logFramesQueued:
+// Returns: frames waiting for ITM, including one partly sent
+uint32_t logFramesQueued(void) {
+    return frame_head - frame_tail;
+}
+
+// Formats the oldest ready record into the text queue if it has room for a full line
+static void formatRecord(void) {
+    LogRecord * record = &records[record_tail & LOG_SLOT_MASK];
+    char line[LOG_LINE_MAX];
+
+    if (!record->ready || textFree() < LOG_LINE_MAX)
+        return;
+    __DMB(); // flag before contents
+
+    int len = snprintf(line, sizeof(line), record->format, (unsigned long) record->arg[0],
+                       (unsigned long) record->arg[1], (unsigned long) record->arg[2],
+                       (unsigned long) record->arg[3]);
+    record->ready = 0;
+    __DMB(); // slot is free only after it has been read
+    record_tail++;
+
+    if (len > (int) sizeof(line) - 1)
+        len = sizeof(line) - 1;
+    if (len > 0)
+        textPut(line, len);
+}
+
+// Adds a line with the running dropped count whenever it has changed since the last report
+static void reportDropped(void) {
+    uint32_t count = dropped;
+    char line[LOG_LINE_MAX];
+
+    if (count == reported || textFree() < LOG_LINE_MAX)
+        return;
+    int len = snprintf(line, sizeof(line), "log: %lu messages dropped\n", (unsigned long) count);
+    textPut(line, len);
+    reported = count;
+}
+
+// Returns: 1 if the debugger has enabled ITM and the stimulus port
+static int itmPortOpen(int port) {
+    return (ITM->TCR & ITM_TCR_ITMENA_Msk) && (ITM->TER & (1UL << port));
+}
+
+// Returns: bytes queued that can be read without wrapping
+static uint32_t textContiguous(void) {
+    uint32_t queued = text_head - text_tail;
+    uint32_t to_end = LOG_TEXT_BYTES - (text_tail & LOG_TEXT_MASK);
+    return (queued < to_end) ? queued : to_end;
+}
+
+// Sends up to LOG_PUMP_WORDS writes to the ITM text port, stopping as soon as its FIFO is full
+static void sendTextItm(void) {
+    // Nothing is listening: throw the text away like ITM_SendChar() does
+    if (!itmPortOpen(LOG_TEXT_PORT)) {
+        text_tail = text_head;
+        return;
+    }
+
+    for (int i = 0; i < LOG_PUMP_WORDS && text_tail != text_head; i++) {
+        if (ITM->PORT[LOG_TEXT_PORT].u32 == 0)
+            return; // FIFO full, try again next call
+
+        if (text_head - text_tail >= 4) {
+            // Four characters per stimulus write, little endian = in order on the wire
+            uint32_t word = 0;
+            for (int k = 0; k < 4; k++)
+                word |= (uint32_t)(uint8_t) text[(text_tail + k) & LOG_TEXT_MASK] << (8 * k);
+            ITM->PORT[LOG_TEXT_PORT].u32 = word;
+            text_tail += 4;
+        }
+        else {
+            ITM->PORT[LOG_TEXT_PORT].u8 = (uint8_t) text[text_tail & LOG_TEXT_MASK];
+            text_tail++;
+        }
+    }
+}
+
+// Hands up to LOG_USART_CHUNK bytes and a 0 delimiter to the USART transmitter if it has room
+static void sendTextUsart(void) {
+    uint8_t chunk[LOG_USART_CHUNK + 1];
+
+    if (!usartTxReady()) {
+        text_tail = text_head; // no serial link in this build
+        return;
+    }
+    uint32_t len = textContiguous();
+    uint32_t room = usartTxRoom();
+    if (len > LOG_USART_CHUNK)
+        len = LOG_USART_CHUNK;
+    if (len + 1 > room)
+        len = (room > 1) ? room - 1 : 0;
+    if (len == 0)
+        return;
+
+    memcpy(chunk, &text[text_tail & LOG_TEXT_MASK], len);
+    chunk[len] = 0;
+    if (usartTxWrite(chunk, len + 1))
+        text_tail += len;
+}
+
+// Copies as much text as fits into the RTT up buffer
+static void sendTextRtt(void) {
+    uint32_t len = textContiguous();
+    if (len > 0)
+        text_tail += logRttWrite(&text[text_tail & LOG_TEXT_MASK], len);
+}
+
+// Feeds the selected output
+static void sendText(void) {
+    switch (log_output) {
+        case LOG_OUTPUT_USART:
+            sendTextUsart();
+            break;
+        case LOG_OUTPUT_RTT:
+            sendTextRtt();
+            break;
+        default:
+            sendTextItm();
+            break;
+    }
+}
+
+// Sends up to LOG_PUMP_WORDS writes of queued frames to the frame port
+static void sendFrames(void) {
+    if (!itmPortOpen(LOG_FRAME_PORT)) {
+        frame_tail = frame_head;
+        frame_sent = 0;
+        return;
+    }
+
+    for (int i = 0; i < LOG_PUMP_WORDS && frame_tail != frame_head; i++) {
+        if (ITM->PORT[LOG_FRAME_PORT].u32 == 0)
+            return;
+
+        uint32_t slot = frame_tail & (LOG_FRAMES - 1);
+        const uint8_t * frame = frames[slot];
+        uint32_t left = frame_len[slot] - frame_sent;
+        if (left >= 4) {
+            ITM->PORT[LOG_FRAME_PORT].u32 = frame[frame_sent] | (uint32_t) frame[frame_sent + 1] << 8 |
+                                            (uint32_t) frame[frame_sent + 2] << 16 |
+                                            (uint32_t) frame[frame_sent + 3] << 24;
+            frame_sent += 4;
+        }
+        else {
+            ITM->PORT[LOG_FRAME_PORT].u8 = frame[frame_sent];
+            frame_sent++;
+        }
+        if (frame_sent == frame_len[slot]) {
+            frame_sent = 0;
+            frame_tail++;
+        }
+    }
+}
+
+// Function logSetOutput:
+// Sends text to another output from now on; text already queued goes there too
+// Arguments: LOG_OUTPUT_ITM, LOG_OUTPUT_USART or LOG_OUTPUT_RTT
+void logSetOutput(int output) {
+    log_output = output;
+}
+
+// Function logPump:
+// Does a bounded slice of logging work: formats at most one record and sends at most LOG_PUMP_WORDS
+// words from each queue. Main loop only; meant to be called from idle loops.
+void logPump(void) {
+    formatRecord();
+    reportDropped();
+    sendText();
+    sendFrames();
+}
+
+// Function logFlush:
+// Pumps until every queued message has been sent (blocks on the output). Use before sleeping.
+// Gives up after LOG_FLUSH_STALL pumps in a row move nothing, e.g. an RTT buffer no viewer is reading.
+void logFlush(void) {
+    uint32_t stalled = 0;
+
+    while (record_tail != record_head || text_tail != text_head || reported != dropped || frame_tail != frame_head) {
+        uint32_t text_before = text_tail, frame_before = frame_tail, sent_before = frame_sent;
+        uint32_t record_before = record_tail;
+        logPump();
+        if (text_tail != text_before || frame_tail != frame_before || frame_sent != sent_before ||
+            record_tail != record_before)
+            stalled = 0;
+        else if (++stalled == LOG_FLUSH_STALL)
+            return;
+    }
+}
+
+// Function logDropped:
+// Returns: messages dropped so far because a queue was full
+uint32_t logDropped(void) {
+    return dropped;
+}
+
+// Function used by printf to send characters to the laptop. The text is queued and sent from the idle
+// loop to whichever output is selected (ITM, serial link or RTT), never waited on here. Lives here rather
+// than in a main file so every program that links the logger gets printf.
+int _write(int file, char *ptr, int len) {
+  (void) file; // stdout and stderr go to the same place
+  return logWrite(ptr, len);
+}
+
+#ifdef __SEGGER_RTL_VERSION
+// The SEGGER runtime library doesn't call _write(). With LIBRARY_IO_TYPE="STD" in the project it calls
+// these hooks instead, so printf reaches the same queue. stdout and stderr are write only; there is no stdin.
+struct __SEGGER_RTL_FILE_impl { int handle; };
+
+static FILE stdin_file = { 0 };
+static FILE stdout_file = { 1 };
+static FILE stderr_file = { 2 };
+FILE * stdin = &stdin_file;
+FILE * stdout = &stdout_file;
+FILE * stderr = &stderr_file;
+
+int __SEGGER_RTL_X_file_write(FILE * stream, const char * s, unsigned len) {
+    return _write(stream->handle, (char *) s, (int) len);
+}
+
+int __SEGGER_RTL_X_file_stat(FILE * stream) {
+    return (stream->handle == 0) ? -1 : 0;
+}
+
+int __SEGGER_RTL_X_file_bufsize(FILE * stream) {
+    (void) stream;
+    return 1; // logWrite() is cheap, nothing to gain from buffering in the library
+}
+#endif
@@ -0,0 +1,63 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 25, 2025
+File function: Header for the non-blocking logger. Messages are queued in RAM and sent a little at a time
+from the idle loop, so nothing that logs ever waits on the output. Interrupt handlers log through
+logEvent(), which only stores a format pointer and its arguments; printf() from the main loop lands in
+the same output queue through _write(). When either queue is full the message is dropped and counted,
+and the count is reported in the output once there is room again. Binary frames (telemetry.h) have their
+own queue and go out on a second stimulus port, so they never interleave with text.
+
+Text goes to one of three outputs, picked at build time with LOG_OUTPUT and changeable at run time with
+logSetOutput() (or by writing log_output from the debugger):
+    LOG_OUTPUT_ITM   - ITM stimulus port 0 over SWO, as ITM_SendChar() did
+    LOG_OUTPUT_USART - the serial link through usart_tx.c. Each chunk is followed by a 0 byte, so a
+                       telemetry decoder on the same link sees it as a frame of its own (terminals ignore it)
+    LOG_OUTPUT_RTT   - SEGGER RTT up buffer 0 (log_rtt.c), read by the J-Link without stopping the core
+Each output takes only what it has room for and leaves the rest queued.
+*/
+
+#ifndef LOG_BUFFER_H
+#define LOG_BUFFER_H
+
+#include <stdint.h>
+#include <stm32l432xx.h>
+
+#define LOG_SLOTS       32     // logEvent() records waiting to be formatted (power of 2)
+#define LOG_TEXT_BYTES  4096   // formatted text waiting for the output (power of 2)
+#define LOG_LINE_MAX    96     // longest line one logEvent() record can format to
+#define LOG_PUMP_WORDS  4      // most ITM writes per queue per logPump() call, keeps each idle iteration short
+#define LOG_FRAMES      16     // binary frames waiting for ITM (power of 2)
+#define LOG_FRAME_MAX   32     // longest frame logFrame() accepts
+#define LOG_TEXT_PORT   0      // ITM stimulus port for text (the one printf viewers show)
+#define LOG_FRAME_PORT  1      // ITM stimulus port for binary frames
+#define LOG_USART_CHUNK 64     // most text bytes per usartTxWrite()
+#define LOG_FLUSH_STALL 100000 // logFlush() gives up after this many pumps without progress (nobody reading)
+
+// Values which log_output can take on
+#define LOG_OUTPUT_ITM   0
+#define LOG_OUTPUT_USART 1
+#define LOG_OUTPUT_RTT   2
+
+#ifndef LOG_OUTPUT
+#define LOG_OUTPUT LOG_OUTPUT_ITM // text output at reset
+#endif
+
+extern volatile int log_output;
+
+///////////////////////////////////////////////////////////////////////////////
+// Function prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+void logEvent(const char * format, uint32_t a, uint32_t b, uint32_t c, uint32_t d);
+int logWrite(const char * text, int len);
+int logFrame(const uint8_t * frame, uint32_t len);
+uint32_t logFramesQueued(void);
+void logSetOutput(int output);
+void logPump(void);
+void logFlush(void);
+uint32_t logDropped(void);
+int _write(int file, char *ptr, int len);
+
+#endif // LOG_BUFFER_H
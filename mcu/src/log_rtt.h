@@ -0,0 +1,24 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 29, 2025
+File function: Header for a minimal SEGGER RTT up channel used as a log_buffer.c output. The J-Link reads
+the ring straight out of RAM while the core runs, so a write is a memcpy and an index update. A write
+never waits: it takes what fits and leaves the rest queued in log_buffer.c.
+*/
+
+#ifndef LOG_RTT_H
+#define LOG_RTT_H
+
+#include <stdint.h>
+
+#define LOG_RTT_BUFFER 1024 // up buffer 0 in bytes
+
+///////////////////////////////////////////////////////////////////////////////
+// Function prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+void initLogRtt(void);
+uint32_t logRttWrite(const char * data, uint32_t len);
+
+#endif // LOG_RTT_H
@@ -20,5 +20,94 @@
 #define BUTTON_PIN PA4
 #define DELAY_TIM TIM15
 #define COUNT_TIM TIM2
+#define COUNT_TIM_FREQ 1000000 // COUNT_TIM tick rate set by initCounterTIM() (Hz)
+
+// Encoder measurement strategy (selected at build time)
+#define ENCODER_MODE_EXTI    0 // interrupt on every A/B edge (PA6/PA9)
+#define ENCODER_MODE_COUNTER 1 // TIM1 encoder interface, counter sampled by main loop (PA8/PA9)
+#define ENCODER_MODE_CAPTURE 2 // COUNT_TIM input capture + DMA edge timestamps (PA0/PA1)
+#define ENCODER_MODE_HYBRID  3 // EXTI per edge at low speed, TIM1 counter sampling at high speed (PA8/PA9)
+#define ENCODER_MODE_LOWPOWER 4 // LPTIM1 encoder counting with the core in Stop 2 (PB5/PB7)
+
+#ifndef ENCODER_MODE
+#define ENCODER_MODE ENCODER_MODE_EXTI
+#endif
+
+// Velocity estimator for the EXTI and capture modes
+#define VELOCITY_EST_PERIOD 0 // invert the period of the last quadrature cycle
+#define VELOCITY_EST_MT     1 // M/T: edges per window / exact time they span (velocity_mt.c)
+#define VELOCITY_EST_LSQ    2 // least-squares fit over the last LSQ_WINDOW edges (velocity_lsq.c)
+#define VELOCITY_EST_EDGE   3 // single edge period corrected by the learned slot table (slot_comp.c)
+#define VELOCITY_EST_INDEX  4 // one full turn over the time between index pulses (needs ENCODER_INDEX)
+
+#ifndef VELOCITY_ESTIMATOR
+#define VELOCITY_ESTIMATOR VELOCITY_EST_MT
+#endif
+
+#define ENCODER_PPR 408 // pulses per revolution of the encoder disk
+
+// Encoders serviced by EXTI (rows of encoder_table in lab5_main.c, axis 0 is the main one)
+#ifndef ENCODER_AXES
+#define ENCODER_AXES 1
+#endif
+
+#define SLOT_SAVE_PASSES 32 // save the slot table once every segment has been learned this many times
+
+// Hardware encoder interface (TIM1 CH1/CH2 on PA8/PA9, AF1)
+#define ENC_TIM TIM1
+#define ENC_TIM_A_PIN PA8
+#define ENC_TIM_B_PIN PA9
+
+// Hybrid mode switch points in x4 edges per second; the gap between them is the hysteresis
+#define HYBRID_COUNTER_ABOVE 40000 // mask EXTI and sample TIM1 above this rate
+#define HYBRID_EDGE_BELOW    20000 // unmask EXTI again below this rate
+#define HYBRID_EDGE_BUDGET   (2 * HYBRID_COUNTER_ABOVE / (1000 / SAMPLE_PERIOD_MS)) // most EXTI edges per main loop pass
+#define HYBRID_SETTLE_US     50000 // keep reporting the counter velocity this long after unmasking EXTI
+
+// Index (Z) pulse on COUNT_TIM CH4 input capture (PA3, AF1); EXTI, hybrid and capture modes only
+#ifndef ENCODER_INDEX
+#define ENCODER_INDEX 0 // 1 if the encoder's Z output is wired to INDEX_PIN
+#endif
+#define INDEX_PIN  PA3
+#define INDEX_MODE INDEX_CORRECT // INDEX_CORRECT (multi-turn) or INDEX_ZERO (restart at 0 every turn)
+
+// Low-power mode (LPTIM1_IN1/IN2 on PB5/PB7, AF1)
+#define LP_ENC_A_PIN PB5
+#define LP_ENC_B_PIN PB7
+#define LOWPOWER_REPORT_MS   PRINT_PERIOD_MS // RTC wakeup period: velocity is updated and printed this often
+#define LOWPOWER_WAKE_COUNTS 1024            // also wake after this many x4 edges (must be < 32768)
+
+// Input capture inputs (COUNT_TIM CH1/CH2 on PA0/PA1, AF1)
+#define CAP_A_PIN PA0
+#define CAP_B_PIN PA1
+
+// Zero-speed timeout (COUNT_TIM CH3 output compare, see zero_speed.c)
+#define ZERO_SPEED_FACTOR 4      // stopped if no edge within this many times the last edge period
+#define ZERO_SPEED_MIN_US 2000   // shortest timeout (us)
+#define ZERO_SPEED_MAX_US 100000 // longest timeout = worst-case detection latency (us)
+
+// Serial link: USART1 (1: TX PA9 / RX PA10, capture mode only), USART2 (2: TX PA2 / RX PA15, the ST-LINK
+// virtual COM port) or 0 for none. Takes host commands, and carries telemetry if TELEMETRY_USART is 1 and
+// text while the log output is LOG_OUTPUT_USART (log_buffer.h).
+#ifndef SERIAL_USART
+#if ENCODER_MODE == ENCODER_MODE_CAPTURE
+#define SERIAL_USART 0 // USART2 TX DMA is DMA1 channel 7, which capture mode uses
+#else
+#define SERIAL_USART 2
+#endif
+#endif
+#define SERIAL_BAUD       2000000         // up to 10 Mbaud from an 80 MHz kernel clock (8x oversampling)
+#define SERIAL_CLOCK      USART_CLK_PCLK  // kernel clock, see STM32L432KC_USART.h
+#define SERIAL_FLOW       USART_FLOW_NONE // USART_FLOW_RTS_CTS if the host wires RTS/CTS (the ST-LINK VCP has none)
+
+// Telemetry link (TELEMETRY 1 in telemetry.h): 0 = ITM stimulus port 1, 1 = the serial link
+#ifndef TELEMETRY_USART
+#define TELEMETRY_USART 0
+#endif
+#define TELEMETRY_DECIMATION_MAX 16 // under backpressure send as few as one sample in this many
+
+// Main loop timing
+#define SAMPLE_PERIOD_MS 10  // how often the main loop samples encoder state
+#define PRINT_PERIOD_MS  800 // how often velocity is printed
 
 #endif // MAIN_H
\ No newline at end of file
@@ -0,0 +1,63 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 11, 2025
+File function: Table-driven x4 quadrature decoder. Each (previous AB, current AB) pair indexes a 16 entry
+table that gives the step directly, so decoding is one lookup with no branches on pin levels.
+*/
+
+#include "quad_decoder.h"
+
+// Step for index (prev AB << 2) | cur AB
+const int8_t QUAD_TABLE[16] = {
+//  cur: 00            01            10            11
+         0,           -1,           +1,            QUAD_ILLEGAL, // prev 00
+        +1,            0,            QUAD_ILLEGAL, -1,           // prev 01
+        -1,            QUAD_ILLEGAL, 0,            +1,           // prev 10
+         QUAD_ILLEGAL, +1,           -1,            0            // prev 11
+};
+
+// Function quadDecoderInit:
+// Resets the decoder to the current encoder state
+// Arguments: ab is the current AB state, now is the current timestamp
+void quadDecoderInit(QuadDecoder * decoder, uint8_t ab, uint32_t now) {
+    decoder->position = 0;
+    decoder->illegal = 0;
+    decoder->last_time = now;
+    decoder->edge_period = 0;
+    decoder->cycle_period = 0;
+    for (int i = 0; i < 4; i++)
+        decoder->edge_time[i] = now;
+    decoder->edge_index = 0;
+    decoder->state = ab & 0b11;
+    decoder->direction = 0;
+}
+
+// Function quadDecoderUpdate:
+// Decodes one new AB sample and updates position, direction and edge timing
+// Arguments: ab is the new AB state, now is the timestamp of the sample
+// Returns: +1 or -1 for a counted edge, 0 for no change or an illegal double transition
+int quadDecoderUpdate(QuadDecoder * decoder, uint8_t ab, uint32_t now) {
+    ab &= 0b11;
+    int step = quadStep(decoder->state, ab);
+    decoder->state = ab;
+
+    if (step == QUAD_ILLEGAL) {
+        decoder->illegal++;
+        return 0;
+    }
+    if (step == 0)
+        return 0;
+
+    decoder->position += step;
+    decoder->direction = (int8_t) step;
+
+    // edge_time[edge_index] holds the edge four counted edges ago
+    decoder->cycle_period = now - decoder->edge_time[decoder->edge_index];
+    decoder->edge_time[decoder->edge_index] = now;
+    decoder->edge_index = (decoder->edge_index + 1) & 0b11;
+
+    decoder->edge_period = now - decoder->last_time;
+    decoder->last_time = now;
+    return step;
+}
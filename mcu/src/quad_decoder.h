@@ -0,0 +1,56 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 11, 2025
+File function: Header for the table-driven x4 quadrature decoder shared by the interrupt and polling programs.
+Nothing in here touches hardware so the same code builds on the host.
+*/
+
+#ifndef QUAD_DECODER_H
+#define QUAD_DECODER_H
+
+#include <stdint.h>
+
+// Define QUAD_POSITION_64 for a 64 bit position count (never wraps in practice)
+#ifdef QUAD_POSITION_64
+typedef int64_t quad_position_t;
+#else
+typedef int32_t quad_position_t;
+#endif
+
+// Encoder state is packed as AB: bit 1 = A, bit 0 = B
+// Forward (CW, A leads B) sequence is 00 -> 10 -> 11 -> 01 -> 00
+typedef struct {
+    quad_position_t position; // signed edge count (x4 resolution)
+    uint32_t illegal;         // transitions where A and B both changed (an edge was missed)
+    uint32_t last_time;       // timestamp of the last counted edge
+    uint32_t edge_period;     // ticks between the last two counted edges
+    uint32_t cycle_period;    // ticks spanned by the last four counted edges (one full slot)
+    uint32_t edge_time[4];    // timestamps of the last four counted edges
+    uint8_t edge_index;       // next slot in edge_time
+    uint8_t state;            // last AB state seen
+    int8_t direction;         // +1 (CW) or -1 (CCW) of the last counted edge
+} QuadDecoder;
+
+#define QUAD_ILLEGAL 2 // quadStep() result when both A and B changed: direction unknown
+
+extern const int8_t QUAD_TABLE[16];
+
+// Step from one AB state to the next: +1, -1, 0 (no change) or QUAD_ILLEGAL
+static inline int quadStep(uint8_t prev, uint8_t cur) {
+    return QUAD_TABLE[((prev & 0b11) << 2) | (cur & 0b11)];
+}
+
+// Packs the A and B bits of one GPIO IDR read into an AB state
+static inline uint8_t quadStateFromIDR(uint32_t idr, int a_offset, int b_offset) {
+    return (uint8_t)((((idr >> a_offset) & 1) << 1) | ((idr >> b_offset) & 1));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Function prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+void quadDecoderInit(QuadDecoder * decoder, uint8_t ab, uint32_t now);
+int quadDecoderUpdate(QuadDecoder * decoder, uint8_t ab, uint32_t now);
+
+#endif // QUAD_DECODER_H
@@ -0,0 +1,196 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 16, 2025
+File function: Learns the spacing error of every edge on the encoder disk while the shaft turns at near
+constant speed. A segment's share of one revolution's time is its true angular width, so
+gain = (revolution time / edges) / segment time corrects each raw edge period with one table lookup and
+multiply. The ISR only queues steady-speed measurements; the division that turns them into gains is done
+by slotCompUpdate() in the main loop. A table stored in flash is lined up with the current (arbitrary)
+zero position by matching it against one freshly measured revolution.
+*/
+
+#include "slot_comp.h"
+
+// Function slotCompInit:
+// Starts with nominal gains
+// Arguments: have_stored is nonzero if a stored table will be handed to slotCompAlign(), now is the time
+void slotCompInit(SlotComp * comp, int have_stored, uint32_t now) {
+    for (int i = 0; i < SLOT_COMP_EDGES; i++) {
+        comp->gain[i] = SLOT_GAIN_ONE;
+        comp->fresh[i] = 0;
+        comp->seen[i] = now;
+    }
+    comp->last_time = now;
+    comp->last_rev = 0;
+    comp->run = 0;
+    comp->learned = 0;
+    comp->fresh_count = 0;
+    comp->ring_head = 0;
+    comp->ring_tail = 0;
+    comp->skipped = 0;
+    comp->stride = 0;
+    comp->edge = 0;
+    comp->direction = 0;
+    comp->mode = have_stored ? SLOT_ALIGN : SLOT_LEARN;
+}
+
+// Queues one measurement of a segment for slotCompUpdate(), if the speed is steady enough to trust it
+static void slotCompMeasure(SlotComp * comp, uint16_t segment, uint32_t period, uint32_t rev) {
+    uint32_t prev = comp->last_rev;
+    comp->last_rev = rev;
+
+    uint32_t change = (rev > prev) ? rev - prev : prev - rev;
+    if (period == 0 || change > (rev >> SLOT_STEADY_SHIFT))
+        return;
+
+    uint32_t head = comp->ring_head;
+    if (head - comp->ring_tail == SLOT_RING) {
+        comp->skipped++; // the main loop catches the segment on a later revolution
+        return;
+    }
+    SlotMeasurement * m = &comp->ring[head & (SLOT_RING - 1)];
+    m->period = period;
+    m->rev = rev;
+    m->segment = segment;
+    comp->ring_head = head + 1;
+}
+
+// Turns one measurement into a gain and refines (or, while aligning, records) that segment
+static void slotCompLearn(SlotComp * comp, const SlotMeasurement * m) {
+    uint64_t target = ((uint64_t) m->rev * SLOT_GAIN_ONE + (uint64_t) m->period * SLOT_COMP_EDGES / 2) /
+                      ((uint64_t) m->period * SLOT_COMP_EDGES);
+    if (target < SLOT_GAIN_ONE / 2) target = SLOT_GAIN_ONE / 2;
+    if (target > 0xFFFF) target = 0xFFFF;
+
+    if (comp->mode == SLOT_ALIGN) {
+        if (comp->fresh[m->segment] == 0)
+            comp->fresh_count++;
+        comp->fresh[m->segment] = (uint16_t) target;
+    }
+    else if (comp->mode == SLOT_LEARN) {
+        // Early passes over the disk take bigger steps (the first one takes the measurement as is), so a
+        // fresh table settles in a few revolutions and then averages out noise at the full shift
+        uint32_t shift = comp->learned / SLOT_COMP_EDGES;
+        if (shift > SLOT_LEARN_SHIFT)
+            shift = SLOT_LEARN_SHIFT;
+        int32_t gain = comp->gain[m->segment];
+        gain += ((int32_t) target - gain) / (1 << shift);
+        comp->gain[m->segment] = (uint16_t) gain;
+        comp->learned++;
+    }
+}
+
+// Function slotCompEdge:
+// Call for every counted edge (from the encoder ISR)
+// Arguments: step is +1 or -1 from the decoder, now is the edge timestamp
+// Returns: the time since the previous edge corrected for this segment's spacing error, in ticks with
+// SLOT_PERIOD_Q fractional bits (UINT32_MAX if that doesn't fit)
+uint32_t slotCompEdge(SlotComp * comp, int step, uint32_t now) {
+    uint32_t period = now - comp->last_time;
+    uint16_t segment;
+    comp->last_time = now;
+
+    // A segment is named after the edge at its forward end
+    if (step > 0) {
+        comp->edge = (comp->edge + 1 == SLOT_COMP_EDGES) ? 0 : comp->edge + 1;
+        segment = comp->edge;
+    }
+    else {
+        segment = comp->edge;
+        comp->edge = (comp->edge == 0) ? SLOT_COMP_EDGES - 1 : comp->edge - 1;
+    }
+
+    if (step != comp->direction) {
+        comp->direction = (int8_t) step;
+        comp->run = 0;
+    }
+    else if (comp->run < SLOT_COMP_EDGES) {
+        comp->run++;
+    }
+
+    // seen[] only holds a full revolution once we've gone all the way round without reversing. The
+    // segment measured is the one half a revolution back, in the middle of the revolution just timed, so
+    // a steady acceleration lengthens the revolution and the segment alike.
+    if (comp->stride > 0)
+        comp->stride--;
+    else if (comp->run >= SLOT_COMP_EDGES && comp->mode != SLOT_OFF) {
+        uint16_t mid = (comp->edge >= SLOT_COMP_EDGES / 2) ? comp->edge - SLOT_COMP_EDGES / 2
+                                                           : comp->edge + SLOT_COMP_EDGES / 2;
+        uint16_t before = (mid == 0) ? SLOT_COMP_EDGES - 1 : mid - 1;
+        uint32_t mid_period = (step > 0) ? comp->seen[mid] - comp->seen[before]
+                                         : comp->seen[before] - comp->seen[mid];
+        comp->stride = SLOT_LEARN_STRIDE - 1;
+        slotCompMeasure(comp, mid, mid_period, now - comp->seen[comp->edge]);
+    }
+    comp->seen[comp->edge] = now;
+
+    // Q15 gain to Q(SLOT_PERIOD_Q) period, rounded to nearest
+    uint64_t corrected = ((uint64_t) period * comp->gain[segment] + (1u << (14 - SLOT_PERIOD_Q))) >>
+                         (15 - SLOT_PERIOD_Q);
+    return (corrected > UINT32_MAX) ? UINT32_MAX : (uint32_t) corrected;
+}
+
+// Function slotCompUpdate:
+// Folds the measurements queued by slotCompEdge() into the gains. Main loop only.
+void slotCompUpdate(SlotComp * comp) {
+    uint32_t tail = comp->ring_tail;
+
+    while (tail != comp->ring_head) {
+        slotCompLearn(comp, &comp->ring[tail & (SLOT_RING - 1)]);
+        comp->ring_tail = ++tail;
+    }
+}
+
+// Returns nonzero once enough of a revolution has been measured to line up a stored table
+int slotCompAlignReady(const SlotComp * comp) {
+    return comp->mode == SLOT_ALIGN && comp->fresh_count >= SLOT_COMP_EDGES * 3 / 4;
+}
+
+// Function slotCompAlign:
+// Finds the rotation of a stored table that best matches the fresh measurements, loads it and resumes
+// learning. Runs in the main loop (about SLOT_COMP_EDGES^2 cheap operations).
+// Arguments: stored is a table saved by an earlier run
+// Returns: the rotation applied (stored index = current index + rotation)
+int slotCompAlign(SlotComp * comp, const uint16_t * stored) {
+    uint32_t best_cost = UINT32_MAX;
+    int best = 0;
+
+    for (int offset = 0; offset < SLOT_COMP_EDGES; offset++) {
+        uint32_t cost = 0;
+        int j = offset;
+        for (int i = 0; i < SLOT_COMP_EDGES && cost < best_cost; i++) {
+            if (comp->fresh[i] != 0) {
+                int32_t diff = (int32_t) comp->fresh[i] - stored[j];
+                cost += (uint32_t)(diff < 0 ? -diff : diff);
+            }
+            if (++j == SLOT_COMP_EDGES) j = 0;
+        }
+        if (cost < best_cost) {
+            best_cost = cost;
+            best = offset;
+        }
+    }
+
+    int j = best;
+    for (int i = 0; i < SLOT_COMP_EDGES; i++) {
+        comp->gain[i] = stored[j];
+        if (++j == SLOT_COMP_EDGES) j = 0;
+    }
+    if (comp->learned < (uint32_t) SLOT_COMP_EDGES * SLOT_LEARN_SHIFT)
+        comp->learned = (uint32_t) SLOT_COMP_EDGES * SLOT_LEARN_SHIFT; // settled already: refine at the full shift
+    comp->mode = SLOT_LEARN;
+    return best;
+}
+
+// Function slotCompResync:
+// Picks the edge count back up after edges were not passed in for a while (hybrid counter mode).
+// The edge number is the x4 position modulo SLOT_COMP_EDGES, as it is when every edge is seen.
+// Arguments: position is the x4 position at time now
+void slotCompResync(SlotComp * comp, int32_t position, uint32_t now) {
+    int32_t edge = position % SLOT_COMP_EDGES;
+    comp->edge = (uint16_t)(edge < 0 ? edge + SLOT_COMP_EDGES : edge);
+    comp->last_time = now;
+    comp->direction = 0;
+    comp->run = 0; // seen[] is stale: wait for a full revolution before learning again
+}
@@ -0,0 +1,75 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 16, 2025
+File function: Header for online per-slot encoder disk error compensation.
+Nothing in here touches hardware so the same code builds on the host.
+*/
+
+#ifndef SLOT_COMP_H
+#define SLOT_COMP_H
+
+#include <stdint.h>
+
+// Edges per revolution with x4 decoding; must equal ENCODER_PPR * 4
+#ifndef SLOT_COMP_EDGES
+#define SLOT_COMP_EDGES (408 * 4)
+#endif
+
+#define SLOT_GAIN_ONE     32768 // gain of a perfectly spaced edge (Q15)
+#define SLOT_STEADY_SHIFT 6     // learn only while revolution time changes < 1/64 between measurements
+#define SLOT_LEARN_SHIFT  4     // each update moves a gain 1/16 of the way to the new measurement
+#define SLOT_PERIOD_Q     8     // fractional bits of the period slotCompEdge() returns
+#define SLOT_RING         128   // edge measurements waiting for slotCompUpdate() (power of 2)
+#ifndef SLOT_LEARN_STRIDE
+#define SLOT_LEARN_STRIDE 5     // measure one edge in this many; a prime not dividing SLOT_COMP_EDGES, so
+                                // successive revolutions shift through every segment
+#endif
+
+#if SLOT_COMP_EDGES % SLOT_LEARN_STRIDE == 0
+#error "SLOT_LEARN_STRIDE must not divide SLOT_COMP_EDGES"
+#endif
+
+// Values which "mode" can take on
+#define SLOT_LEARN 0 // refine the gains in place
+#define SLOT_ALIGN 1 // a stored table is waiting: measure one revolution to find its rotation
+#define SLOT_OFF   2 // apply the gains, stop learning
+
+// One steady-speed edge, measured in the ISR and turned into a gain in the main loop
+typedef struct {
+    uint32_t period;  // raw time the segment took
+    uint32_t rev;     // revolution centred on the segment
+    uint16_t segment;
+} SlotMeasurement;
+
+typedef struct {
+    uint16_t gain[SLOT_COMP_EDGES];  // nominal / actual spacing of the segment ending at each edge (Q15)
+    uint16_t fresh[SLOT_COMP_EDGES]; // gains measured since reset, used by slotCompAlign()
+    uint32_t seen[SLOT_COMP_EDGES];  // time each edge was last passed
+    uint32_t last_time;              // time of the previous edge
+    uint32_t last_rev;               // revolution time at the previous measurement
+    uint32_t run;                    // edges since the last reversal (capped at SLOT_COMP_EDGES)
+    uint32_t learned;                // gain updates since reset
+    uint32_t fresh_count;            // segments with a fresh measurement
+    SlotMeasurement ring[SLOT_RING]; // slotCompEdge() adds, slotCompUpdate() takes
+    volatile uint32_t ring_head;
+    volatile uint32_t ring_tail;
+    uint32_t skipped;                // measurements that found the ring full
+    uint32_t stride;                 // edges until the next one measured
+    uint16_t edge;                   // current edge number, 0 .. SLOT_COMP_EDGES-1
+    int8_t direction;
+    volatile uint8_t mode;
+} SlotComp;
+
+///////////////////////////////////////////////////////////////////////////////
+// Function prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+void slotCompInit(SlotComp * comp, int have_stored, uint32_t now);
+uint32_t slotCompEdge(SlotComp * comp, int step, uint32_t now);
+void slotCompUpdate(SlotComp * comp);
+int slotCompAlignReady(const SlotComp * comp);
+int slotCompAlign(SlotComp * comp, const uint16_t * stored);
+void slotCompResync(SlotComp * comp, int32_t position, uint32_t now);
+
+#endif // SLOT_COMP_H
@@ -0,0 +1,40 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 16, 2025
+File function: Saves and restores the slot compensation table in the last flash pages.
+*/
+
+#include "STM32L432KC_FLASH.h"
+#include "slot_store.h"
+
+#define SLOT_STORE ((const SlotStore *) FLASH_PAGE_ADDR(SLOT_STORE_PAGE))
+#define SLOT_STORE_PAGES ((sizeof(SlotStore) + FLASH_PAGE_BYTES - 1) / FLASH_PAGE_BYTES)
+
+// Function slotStoreLoad:
+// Returns: the stored gain table (read directly from flash), or 0 if none was saved for this resolution
+const uint16_t * slotStoreLoad(void) {
+    if (SLOT_STORE->magic != SLOT_STORE_MAGIC || SLOT_STORE->edges != SLOT_COMP_EDGES)
+        return 0;
+    return SLOT_STORE->gain;
+}
+
+// Function slotStoreSave:
+// Erases the store pages and writes a new table. Code runs from flash, so the CPU (and every
+// interrupt) stalls for the erase; only call this while the shaft is stopped.
+// Arguments: gain is the table to save
+// Returns: 0 on success, -1 on a flash error
+int slotStoreSave(const uint16_t * gain) {
+    uint32_t header[2] = { SLOT_STORE_MAGIC, SLOT_COMP_EDGES }; // magic, edges
+
+    for (uint32_t page = 0; page < SLOT_STORE_PAGES; page++) {
+        if (flashErasePage(SLOT_STORE_PAGE + page) != 0)
+            return -1;
+    }
+
+    // Table first, magic last, so a reset part way through leaves no valid header
+    uint32_t table = FLASH_PAGE_ADDR(SLOT_STORE_PAGE) + 8;
+    if (flashProgram(table, gain, sizeof(SLOT_STORE->gain)) != 0)
+        return -1;
+    return flashProgram(FLASH_PAGE_ADDR(SLOT_STORE_PAGE), header, sizeof(header));
+}
@@ -0,0 +1,31 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 16, 2025
+File function: Header for keeping the learned slot compensation table in flash across resets.
+*/
+
+#ifndef SLOT_STORE_H
+#define SLOT_STORE_H
+
+#include <stdint.h>
+#include "slot_comp.h"
+
+// Last two pages of the 256 KB flash, well clear of the program image
+#define SLOT_STORE_PAGE  126
+#define SLOT_STORE_MAGIC 0x534C4F54 // "SLOT"
+
+typedef struct {
+    uint32_t magic;
+    uint32_t edges;                 // SLOT_COMP_EDGES the table was learned with
+    uint16_t gain[SLOT_COMP_EDGES];
+} SlotStore;
+
+///////////////////////////////////////////////////////////////////////////////
+// Function prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+const uint16_t * slotStoreLoad(void);
+int slotStoreSave(const uint16_t * gain);
+
+#endif // SLOT_STORE_H
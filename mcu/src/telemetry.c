@@ -0,0 +1,108 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 26, 2025
+File function: Framing for the binary telemetry records in telemetry.h: CRC-16/CCITT-FALSE (polynomial
+0x1021, initial value 0xFFFF) and consistent overhead byte stuffing (COBS). The CRC uses a 16 entry table,
+two lookups per byte, which keeps it small and a frame costs a few hundred cycles end to end, against
+thousands for the text report it replaces.
+*/
+
+#include <string.h>
+#include "telemetry.h"
+
+static const uint16_t CRC_NIBBLE[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+};
+
+// Function telemetryCrc:
+// Returns: CRC-16/CCITT-FALSE of len bytes
+uint16_t telemetryCrc(const uint8_t * data, uint32_t len) {
+    uint16_t crc = 0xFFFF;
+    for (uint32_t i = 0; i < len; i++) {
+        crc = (uint16_t)(crc << 4) ^ CRC_NIBBLE[(crc >> 12) ^ (data[i] >> 4)];
+        crc = (uint16_t)(crc << 4) ^ CRC_NIBBLE[(crc >> 12) ^ (data[i] & 0x0F)];
+    }
+    return crc;
+}
+
+// Function cobsEncode:
+// Stuffs len bytes so the output contains no zeros (the caller appends the 0 delimiter)
+// Arguments: out has room for len + len / 254 + 1 bytes
+// Returns: bytes written
+uint32_t cobsEncode(const uint8_t * in, uint32_t len, uint8_t * out) {
+    uint32_t code_at = 0; // where the current block's length byte goes
+    uint32_t n = 1;
+    uint8_t code = 1;     // block length + 1
+
+    for (uint32_t i = 0; i < len; i++) {
+        if (in[i] != 0) {
+            out[n++] = in[i];
+            code++;
+        }
+        if (in[i] == 0 || code == 0xFF) {
+            out[code_at] = code;
+            code_at = n++;
+            code = 1;
+        }
+    }
+    out[code_at] = code;
+    return n;
+}
+
+// Function cobsDecode:
+// Undoes cobsEncode()
+// Arguments: in is one frame without its delimiter, out has room for len bytes
+// Returns: bytes written, 0 if the frame is malformed
+uint32_t cobsDecode(const uint8_t * in, uint32_t len, uint8_t * out) {
+    uint32_t i = 0;
+    uint32_t n = 0;
+
+    while (i < len) {
+        uint8_t code = in[i++];
+        if (code == 0 || i + code - 1 > len)
+            return 0;
+        for (uint8_t k = 1; k < code; k++) {
+            if (in[i] == 0)
+                return 0;
+            out[n++] = in[i++];
+        }
+        if (code != 0xFF && i < len)
+            out[n++] = 0;
+    }
+    return n;
+}
+
+// Function telemetryFrame:
+// Builds the wire form of one record: COBS(record, CRC) and the 0 delimiter
+// Arguments: frame has room for TELEMETRY_FRAME_MAX bytes
+// Returns: frame length
+uint32_t telemetryFrame(const TelemetryRecord * record, uint8_t * frame) {
+    uint8_t payload[TELEMETRY_PAYLOAD];
+
+    memcpy(payload, record, sizeof(TelemetryRecord));
+    uint16_t crc = telemetryCrc(payload, sizeof(TelemetryRecord));
+    payload[sizeof(TelemetryRecord)] = (uint8_t) crc;
+    payload[sizeof(TelemetryRecord) + 1] = (uint8_t)(crc >> 8);
+
+    uint32_t len = cobsEncode(payload, sizeof(payload), frame);
+    frame[len++] = 0;
+    return len;
+}
+
+// Function telemetryParse:
+// Checks and unpacks one received frame
+// Arguments: frame without its 0 delimiter
+// Returns: 1 if it held a record with a good CRC, 0 otherwise
+int telemetryParse(const uint8_t * frame, uint32_t len, TelemetryRecord * record) {
+    uint8_t payload[TELEMETRY_FRAME_MAX];
+
+    if (len > TELEMETRY_FRAME_MAX || cobsDecode(frame, len, payload) != TELEMETRY_PAYLOAD)
+        return 0;
+    uint16_t crc = payload[sizeof(TelemetryRecord)] | (uint16_t) payload[sizeof(TelemetryRecord) + 1] << 8;
+    if (telemetryCrc(payload, sizeof(TelemetryRecord)) != crc)
+        return 0;
+    memcpy(record, payload, sizeof(TelemetryRecord));
+    return 1;
+}
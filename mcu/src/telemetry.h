@@ -0,0 +1,53 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 26, 2025
+File function: Header for the binary telemetry format. Each main loop sample becomes one fixed-size
+TelemetryRecord, followed by a CRC-16 of the record, COBS encoded so the only zero byte in the stream is
+the delimiter after every frame. A receiver that starts mid-stream or loses bytes resynchronizes at the
+next zero. Plain C with no register access, so the host decoder (mcu/host/telemetry_csv.c) builds the same
+file. Multi-byte fields are little endian, as both ends store them.
+*/
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+
+#ifndef TELEMETRY
+#define TELEMETRY 0 // 1: send a TelemetryRecord every sample instead of the periodic text report
+#endif
+
+// Bits of TelemetryRecord.flags
+#define TELEMETRY_FLAG_CW      0x0001 // direction of the last edge
+#define TELEMETRY_FLAG_STOPPED 0x0002 // zero-speed timeout has expired
+#define TELEMETRY_FLAG_COUNTER 0x0004 // velocity came from the TIM1 counter (counter mode, hybrid at speed)
+#define TELEMETRY_FLAG_HOMED   0x0008 // position is relative to the index pulse
+
+typedef struct __attribute__((packed)) {
+    uint16_t sequence;     // +1 every record, so gaps show records lost on the way
+    uint16_t flags;        // TELEMETRY_FLAG_*
+    uint32_t timestamp;    // COUNT_TIM ticks
+    int32_t position;      // x4 counts
+    int32_t velocity;      // rev/s, Q16.16 (velocity_q_t), magnitude only: direction is in flags
+    uint16_t illegal;      // illegal transitions (low 16 bits of the running count)
+    uint16_t lost;         // edges lost: EXTI lines that moved twice, or capture overruns
+    uint16_t cpu_permille; // CPU busy over the load meter's window
+    uint16_t dropped;      // records dropped before leaving the part (queue full)
+    uint16_t decimated;    // samples not sent because the link was backed up (see sendTelemetry())
+} TelemetryRecord;
+
+#define TELEMETRY_PAYLOAD   (sizeof(TelemetryRecord) + 2) // record and CRC
+#define TELEMETRY_FRAME_MAX (TELEMETRY_PAYLOAD + 2)       // COBS adds one byte per 254, then the delimiter
+
+///////////////////////////////////////////////////////////////////////////////
+// Function prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+uint16_t telemetryCrc(const uint8_t * data, uint32_t len);
+uint32_t cobsEncode(const uint8_t * in, uint32_t len, uint8_t * out);
+uint32_t cobsDecode(const uint8_t * in, uint32_t len, uint8_t * out);
+uint32_t telemetryFrame(const TelemetryRecord * record, uint8_t * frame);
+int telemetryParse(const uint8_t * frame, uint32_t len, TelemetryRecord * record);
+
+#endif // TELEMETRY_H
@@ -0,0 +1,135 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 28, 2025
+File function: DMA-driven USART receiver (see usart_rx.h). DMA request mapping (RM 11.3.2): USART2_RX
+is DMA1 channel 6 and USART1_RX is DMA2 channel 7, both request 2. USART1_RX could also use DMA1 channel
+5, but capture mode has that one.
+
+Bytes are counted with a free-running total rather than the DMA position alone. The DMA half and full
+transfer interrupts and the USART idle interrupt all bring it up to date, so it moves by less than a
+ring's length between updates and a lap can never be missed. Frame ends are totals too, so the main loop
+can tell when DMA has overwritten bytes it had not read yet.
+*/
+
+#include "usart_rx.h"
+#include "STM32L432KC_DMA.h"
+
+#define RX_MASK       (USART_RX_BUFFER - 1)
+#define RX_FRAME_MASK (USART_RX_FRAMES - 1)
+
+static USART_TypeDef * rx_usart;
+static DMA_TypeDef * rx_dma;
+static int rx_channel;
+
+static uint8_t ring[USART_RX_BUFFER];
+static uint32_t dma_position = 0;          // ring index DMA had reached at the last update (interrupts only)
+static volatile uint32_t received = 0;     // bytes received since init
+static volatile uint32_t frame_end[USART_RX_FRAMES]; // received count at each idle line
+static volatile uint8_t frame_bad[USART_RX_FRAMES]; // nonzero if bytes of that frame were lost
+static uint8_t damaged = 0;                // a byte of the frame in progress was lost (interrupts only)
+static volatile uint32_t frame_head = 0;   // frame ends written (interrupts)
+static uint32_t frame_tail = 0;            // frame ends read (main loop)
+static uint32_t consumed = 0;              // bytes read or skipped (main loop)
+static volatile uint32_t overruns = 0;     // USART overruns and frame list overflows (interrupts)
+static uint32_t lapped = 0;                // frames DMA overwrote before they were read (main loop)
+
+// Function initUsartRx:
+// Starts circular DMA reception and the idle-line and DMA interrupts. The USART must already be set up
+// by initUSARTClock() (initUsartTx() does it).
+// Arguments: USART1_ID or USART2_ID
+void initUsartRx(int USART_ID) {
+    IRQn_Type usart_irq, dma_irq;
+
+    rx_usart = id2Port(USART_ID);
+    if (USART_ID == USART1_ID) {
+        rx_dma = DMA2;
+        rx_channel = 7;
+        usart_irq = USART1_IRQn;
+        dma_irq = DMA2_Channel7_IRQn;
+    }
+    else {
+        rx_dma = DMA1;
+        rx_channel = 6;
+        usart_irq = USART2_IRQn;
+        dma_irq = DMA1_Channel6_IRQn;
+    }
+
+    initDMA(rx_dma, rx_channel, 2, DMA_PERIPH_TO_MEM, DMA_SIZE_8, DMA_CIRCULAR);
+    dmaChannel(rx_dma, rx_channel)->CCR |= DMA_CCR_HTIE | DMA_CCR_TCIE;
+    startDMA(rx_dma, rx_channel, &rx_usart->RDR, ring, USART_RX_BUFFER);
+
+    rx_usart->ICR = USART_ICR_IDLECF | USART_ICR_ORECF;
+    rx_usart->CR3 |= USART_CR3_DMAR; // RXNE requests a DMA transfer
+    rx_usart->CR1 |= USART_CR1_IDLEIE;
+
+    // Same level as the TX DMA interrupt: below the encoders, and the two RX sources never nest
+    NVIC_SetPriority(usart_irq, 1);
+    NVIC_SetPriority(dma_irq, 1);
+    NVIC_EnableIRQ(usart_irq);
+    NVIC_EnableIRQ(dma_irq);
+}
+
+// Function usartRxIRQ:
+// Call from both the USART's and its RX DMA channel's interrupt handlers. Brings the received count up to
+// date and, on an idle line, records the end of a frame.
+void usartRxIRQ(void) {
+    uint32_t position = (USART_RX_BUFFER - dmaRemaining(rx_dma, rx_channel)) & RX_MASK;
+    received += (position - dma_position) & RX_MASK;
+    dma_position = position;
+    dmaClearFlags(rx_dma, rx_channel);
+
+    uint32_t isr = rx_usart->ISR;
+    if (isr & USART_ISR_ORE) {
+        rx_usart->ICR = USART_ICR_ORECF; // a byte arrived before DMA read the last one
+        overruns++;
+        damaged = 1;
+    }
+    if (isr & USART_ISR_IDLE) {
+        rx_usart->ICR = USART_ICR_IDLECF;
+        if (frame_head - frame_tail >= USART_RX_FRAMES) {
+            overruns++; // main loop is this many frames behind: merge into the newest
+            frame_end[(frame_head - 1) & RX_FRAME_MASK] = received;
+            frame_bad[(frame_head - 1) & RX_FRAME_MASK] = 1;
+        }
+        else if (received != (frame_head ? frame_end[(frame_head - 1) & RX_FRAME_MASK] : 0)) {
+            frame_end[frame_head & RX_FRAME_MASK] = received;
+            frame_bad[frame_head & RX_FRAME_MASK] = damaged;
+            frame_head++;
+        }
+        damaged = 0;
+    }
+}
+
+// Function usartRxFrame:
+// Takes the oldest complete frame. Main loop only; never blocks. DMA may be up to half a ring ahead of
+// the received count, so a frame is only trusted if the reader was within half a ring of it.
+// Arguments: frame receives up to max bytes (the rest of a longer frame is discarded)
+// Returns: bytes copied, 0 if no frame has finished, -1 if this frame lost bytes (skip it; the total
+// lost is in usartRxOverruns())
+int usartRxFrame(uint8_t * frame, int max) {
+    if (frame_tail == frame_head)
+        return 0;
+    uint32_t end = frame_end[frame_tail & RX_FRAME_MASK];
+    int bad = frame_bad[frame_tail & RX_FRAME_MASK];
+    uint32_t start = consumed;
+    frame_tail++;
+
+    int len = 0;
+    for (; consumed != end; consumed++)
+        if (len < max)
+            frame[len++] = ring[consumed & RX_MASK];
+
+    // DMA may have overwritten part of the copy: this frame is gone
+    if (received - start > USART_RX_BUFFER / 2) {
+        lapped++;
+        bad = 1;
+    }
+    return bad ? -1 : len;
+}
+
+// Function usartRxOverruns:
+// Returns: frames lost so far
+uint32_t usartRxOverruns(void) {
+    return overruns + lapped;
+}
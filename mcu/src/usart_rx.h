@@ -0,0 +1,30 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 28, 2025
+File function: Header for the DMA-driven USART receiver. Circular DMA copies every received byte into a
+ring, so nothing is lost however late the main loop looks. The USART's idle-line interrupt marks the end of
+each burst, which splits the stream into variable-length frames (one host command each) without any
+delimiter byte. The main loop takes whole frames with usartRxFrame() and never waits.
+*/
+
+#ifndef USART_RX_H
+#define USART_RX_H
+
+#include <stdint.h>
+#include <stm32l432xx.h>
+#include "STM32L432KC_USART.h"
+
+#define USART_RX_BUFFER 256 // receive ring in bytes (power of 2): the most that can wait to be read
+#define USART_RX_FRAMES 16  // frame ends that can wait to be read (power of 2)
+
+///////////////////////////////////////////////////////////////////////////////
+// Function prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+void initUsartRx(int USART_ID);
+void usartRxIRQ(void);
+int usartRxFrame(uint8_t * frame, int max);
+uint32_t usartRxOverruns(void);
+
+#endif // USART_RX_H
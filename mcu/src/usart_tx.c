@@ -0,0 +1,125 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 27, 2025
+File function: DMA-driven USART transmitter (see usart_tx.h). DMA request mapping (RM 11.3.2):
+USART1_TX is DMA2 channel 6 and USART2_TX is DMA1 channel 7, both request 2. DMA1 channel 7 is also
+TIM2_CH2 for capture mode, so the two cannot share a build on USART2.
+
+Only the writer and the transfer-complete interrupt touch the buffers. The writer masks the DMA interrupt
+in the NVIC (not globally) while it appends, so the encoder interrupts are never held off.
+*/
+
+#include <string.h>
+#include "usart_tx.h"
+#include "STM32L432KC_DMA.h"
+
+static USART_TypeDef * tx_usart = 0; // set by initUsartTx()
+static DMA_TypeDef * tx_dma;
+static int tx_channel;
+static IRQn_Type tx_irq;
+
+static uint8_t buffer[2][USART_TX_BUFFER];
+static uint32_t fill[2];          // bytes queued in each buffer
+static volatile int sending = -1; // buffer DMA is reading, -1 when idle
+static int filling = 0;           // buffer writers append to
+static uint32_t dropped = 0;      // writes that did not fit
+
+// Hands buffer b to DMA; writers move on to the other one
+static void startBuffer(int b) {
+    sending = b;
+    filling = b ^ 1;
+    startDMA(tx_dma, tx_channel, &tx_usart->TDR, buffer[b], (uint16_t) fill[b]);
+}
+
+// Function initUsartTx:
+// Sets up the USART (8N1) and its TX DMA channel and enables the transfer-complete interrupt
+// Arguments: USART1_ID or USART2_ID, baud rate, kernel clock and flow control as for initUSARTClock()
+void initUsartTx(int USART_ID, int baud_rate, int clock, int flow) {
+    tx_usart = initUSARTClock(USART_ID, baud_rate, clock, flow);
+    if (USART_ID == USART1_ID) {
+        tx_dma = DMA2;
+        tx_channel = 6;
+        tx_irq = DMA2_Channel6_IRQn;
+    }
+    else {
+        tx_dma = DMA1;
+        tx_channel = 7;
+        tx_irq = DMA1_Channel7_IRQn;
+    }
+
+    initDMA(tx_dma, tx_channel, 2, DMA_MEM_TO_PERIPH, DMA_SIZE_8, DMA_NORMAL);
+    dmaChannel(tx_dma, tx_channel)->CCR |= DMA_CCR_TCIE;
+    tx_usart->CR3 |= USART_CR3_DMAT; // TXE requests a DMA transfer
+
+    // Below the encoder interrupts (priority 0), so finishing a buffer never delays an edge
+    NVIC_SetPriority(tx_irq, 1);
+    NVIC_EnableIRQ(tx_irq);
+}
+
+// Function usartTxWrite:
+// Queues len bytes to go out in order, starting DMA if it is idle. Main loop only.
+// Returns: 1 if queued, 0 if the buffer being filled had no room (nothing is queued, counted as dropped)
+int usartTxWrite(const uint8_t * data, uint32_t len) {
+    int queued = 0;
+
+    NVIC_DisableIRQ(tx_irq);
+    if (fill[filling] + len <= USART_TX_BUFFER) {
+        memcpy(&buffer[filling][fill[filling]], data, len);
+        fill[filling] += len;
+        if (sending < 0)
+            startBuffer(filling);
+        queued = 1;
+    }
+    else {
+        dropped++;
+    }
+    NVIC_EnableIRQ(tx_irq);
+    return queued;
+}
+
+// Function usartTxComplete:
+// Call from the DMA channel's interrupt handler. Frees the buffer just sent and starts the other one if
+// anything was queued meanwhile.
+void usartTxComplete(void) {
+    dmaClearFlags(tx_dma, tx_channel);
+    if (sending < 0)
+        return;
+    fill[sending] = 0;
+    sending = -1;
+    if (fill[filling] > 0)
+        startBuffer(filling);
+}
+
+// Function usartTxReady:
+// Returns: 1 once initUsartTx() has run
+int usartTxReady(void) {
+    return tx_usart != 0;
+}
+
+// Function usartTxRoom:
+// Returns: bytes the next usartTxWrite() can take, 0 before initUsartTx()
+uint32_t usartTxRoom(void) {
+    if (tx_usart == 0)
+        return 0;
+    return USART_TX_BUFFER - fill[filling];
+}
+
+// Function usartTxBackpressure:
+// Returns: 1 if the link is falling behind: the peer is holding CTS off, or the buffer being filled is
+// already half full while the other one is still going out
+int usartTxBackpressure(void) {
+    return !usartClearToSend(tx_usart) || fill[filling] > USART_TX_BUFFER / 2;
+}
+
+// Function usartTxIdle:
+// Returns: 1 once everything queued has been handed to the USART
+int usartTxIdle(void) {
+    return sending < 0;
+}
+
+// Function usartTxDropped:
+// Returns: writes refused so far because the buffer being filled was full
+uint32_t usartTxDropped(void) {
+    return dropped;
+}
@@ -0,0 +1,32 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 27, 2025
+File function: Header for the DMA-driven USART transmitter. Two buffers alternate: DMA sends one while
+callers append whole frames to the other, and the transfer-complete interrupt starts the next one. Writers
+copy their bytes and return; nothing waits on TXE or TC.
+*/
+
+#ifndef USART_TX_H
+#define USART_TX_H
+
+#include <stdint.h>
+#include <stm32l432xx.h>
+#include "STM32L432KC_USART.h"
+
+#define USART_TX_BUFFER 512 // bytes per buffer: the most that can be queued while the other one is sent
+
+///////////////////////////////////////////////////////////////////////////////
+// Function prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+void initUsartTx(int USART_ID, int baud_rate, int clock, int flow);
+int usartTxWrite(const uint8_t * data, uint32_t len);
+int usartTxReady(void);
+uint32_t usartTxRoom(void);
+void usartTxComplete(void);
+int usartTxBackpressure(void);
+int usartTxIdle(void);
+uint32_t usartTxDropped(void);
+
+#endif // USART_TX_H
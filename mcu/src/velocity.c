@@ -0,0 +1,65 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 10, 2025
+File function: Fixed-point velocity engine. Replaces the three float divisions per edge in the
+interrupt handler with a single integer division done when the velocity is read.
+*/
+
+#include "velocity.h"
+
+// Function velocityScale:
+// Precomputes the reciprocal constant for one timer rate and encoder resolution
+// Arguments: tick_hz is the timestamp clock (Hz), edges_per_rev is edges counted per revolution
+// Returns: (tick_hz << VELOCITY_Q) / edges_per_rev, rounded to nearest
+uint32_t velocityScale(uint32_t tick_hz, uint32_t edges_per_rev) {
+    uint64_t scale = (((uint64_t) tick_hz << VELOCITY_Q) + edges_per_rev / 2) / edges_per_rev;
+    return (uint32_t) scale;
+}
+
+// Function velocityFromPeriod:
+// Converts the time between two consecutive counted edges into velocity
+// Arguments: scale from velocityScale(), period in timer ticks (0 means no measurement)
+// Returns: revolutions per second in Q format, rounded to nearest
+velocity_q_t velocityFromPeriod(uint32_t scale, uint32_t period) {
+    if (period == 0)
+        return 0;
+    return (velocity_q_t) ((scale + period / 2) / period);
+}
+
+// Function velocityFromSpan:
+// Converts a number of edges and the exact time they span into velocity
+// Arguments: scale from velocityScale(), edges counted, span in timer ticks
+// Returns: revolutions per second in Q format, rounded to nearest (saturated if it doesn't fit)
+velocity_q_t velocityFromSpan(uint32_t scale, uint32_t edges, uint32_t span) {
+    if (span == 0)
+        return 0;
+    uint64_t velocity = ((uint64_t) scale * edges + span / 2) / span;
+    return (velocity > INT32_MAX) ? INT32_MAX : (velocity_q_t) velocity;
+}
+
+// Function velocityBound:
+// Caps a velocity at one edge per elapsed time. If no edge has arrived for elapsed ticks the shaft
+// can't be turning faster than that, so the estimate decays as 1/elapsed while it slows down.
+// Arguments: velocity magnitude, scale from velocityScale() for single edges, ticks since the last edge
+velocity_q_t velocityBound(velocity_q_t velocity, uint32_t scale, uint32_t elapsed) {
+    velocity_q_t bound = velocityFromPeriod(scale, elapsed);
+    return (elapsed != 0 && bound < velocity) ? bound : velocity;
+}
+
+// Function velocityBoundSpan:
+// velocityBound() for a measurement spanning several edges (e.g. one revolution between index pulses):
+// caps velocity at that many edges per elapsed time
+// Arguments: velocity magnitude, scale from velocityScale() for single edges, edges spanned, ticks since
+// the span ended
+velocity_q_t velocityBoundSpan(velocity_q_t velocity, uint32_t scale, uint32_t edges, uint32_t elapsed) {
+    velocity_q_t bound = velocityFromSpan(scale, edges, elapsed);
+    return (elapsed != 0 && bound < velocity) ? bound : velocity;
+}
+
+// Function velocityMilli:
+// Converts a Q format velocity to thousandths of a revolution per second for printing
+// without the float formatter
+int32_t velocityMilli(velocity_q_t velocity) {
+    return (int32_t) (((int64_t) velocity * 1000 + (VELOCITY_ONE / 2)) >> VELOCITY_Q);
+}
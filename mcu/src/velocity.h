@@ -0,0 +1,36 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 10, 2025
+File function: Header for the fixed-point velocity engine. Interrupts only record integer edge periods;
+velocity is produced on read as one integer division by a precomputed constant.
+Nothing in here touches hardware so the same code builds on the host.
+*/
+
+#ifndef VELOCITY_H
+#define VELOCITY_H
+
+#include <stdint.h>
+
+// Number of fractional bits in a velocity value. scale = (tick_hz << VELOCITY_Q) / edges_per_rev
+// must fit in 32 bits: Q16 leaves room for a 1 MHz timebase down to 16 edges/rev.
+#ifndef VELOCITY_Q
+#define VELOCITY_Q 16
+#endif
+
+#define VELOCITY_ONE ((velocity_q_t) 1 << VELOCITY_Q) // 1 rev/s
+
+typedef int32_t velocity_q_t; // revolutions per second, signed Q(31-VELOCITY_Q).VELOCITY_Q
+
+///////////////////////////////////////////////////////////////////////////////
+// Function prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+uint32_t velocityScale(uint32_t tick_hz, uint32_t edges_per_rev);
+velocity_q_t velocityFromPeriod(uint32_t scale, uint32_t period);
+velocity_q_t velocityFromSpan(uint32_t scale, uint32_t edges, uint32_t span);
+velocity_q_t velocityBound(velocity_q_t velocity, uint32_t scale, uint32_t elapsed);
+velocity_q_t velocityBoundSpan(velocity_q_t velocity, uint32_t scale, uint32_t edges, uint32_t elapsed);
+int32_t velocityMilli(velocity_q_t velocity);
+
+#endif // VELOCITY_H
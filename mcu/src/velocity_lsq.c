@@ -0,0 +1,131 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 14, 2025
+File function: Least-squares fit of edge time against edge number over the last LSQ_WINDOW edges.
+Because every edge is exactly one count apart, the abscissa is the same every time and the fit only needs
+three running sums. The interrupt handler slides them in O(1) integer work per edge; the main loop solves
+the small normal equations when it wants a velocity. Reversals restart the window.
+*/
+
+#include "velocity_lsq.h"
+
+#define LSQ_BARRIER() __asm volatile ("" ::: "memory")
+
+// Sums of i and i^2 for i = 0 .. LSQ_WINDOW - 2 (the edges left after dropping the oldest)
+#define LSQ_S1 ((int64_t)(LSQ_WINDOW - 1) * (LSQ_WINDOW - 2) / 2)
+#define LSQ_S2 ((int64_t)(LSQ_WINDOW - 2) * (LSQ_WINDOW - 1) * (2 * LSQ_WINDOW - 3) / 6)
+
+// Function lsqReset:
+// Empties the window
+void lsqReset(LsqWindow * window) {
+    window->sequence = 0;
+    window->sums.t0 = 0;
+    window->sums.t1 = 0;
+    window->sums.t2 = 0;
+    window->sums.count = 0;
+    window->sums.direction = 0;
+    window->oldest = 0;
+}
+
+// Function lsqAddEdge:
+// Slides one counted edge into the window. O(1), integer only, safe to call from the encoder ISR.
+// Arguments: time is the edge timestamp, direction is the decoded step (+1 or -1)
+void lsqAddEdge(LsqWindow * window, uint32_t time, int direction) {
+    LsqSums * s = &window->sums;
+
+    window->sequence++; // odd: update in progress
+    LSQ_BARRIER();
+
+    if (s->count == 0 || direction != s->direction) {
+        // First edge, or a reversal: the edge numbering is no longer uniform so start again
+        window->oldest = 0;
+        window->time[0] = time;
+        s->t0 = s->t1 = s->t2 = 0;
+        s->count = 1;
+        s->direction = direction;
+    }
+    else {
+        uint32_t i = s->count;
+        if (s->count == LSQ_WINDOW) {
+            // Drop the oldest edge (i = 0, y = 0) and renumber i -> i - 1
+            s->t2 = s->t2 - 2 * s->t1 + s->t0;
+            s->t1 = s->t1 - s->t0;
+
+            // Re-reference y to the new oldest edge
+            uint32_t old_time = window->time[window->oldest];
+            window->oldest = (window->oldest + 1) % LSQ_WINDOW;
+            int64_t shift = (int64_t)(uint32_t)(window->time[window->oldest] - old_time);
+            s->t0 -= shift * (LSQ_WINDOW - 1);
+            s->t1 -= shift * LSQ_S1;
+            s->t2 -= shift * LSQ_S2;
+            i = LSQ_WINDOW - 1;
+        }
+        else {
+            s->count++;
+        }
+
+        int64_t y = (int64_t)(uint32_t)(time - window->time[window->oldest]);
+        s->t0 += y;
+        s->t1 += (int64_t) i * y;
+        s->t2 += (int64_t)(i * i) * y;
+        window->time[(window->oldest + i) % LSQ_WINDOW] = time;
+    }
+
+    LSQ_BARRIER();
+    window->sequence++; // even: sums are consistent
+}
+
+// Function lsqRead:
+// Copies out a consistent set of sums (retries if lsqAddEdge() ran during the copy)
+void lsqRead(const LsqWindow * window, LsqSums * sums) {
+    uint32_t start;
+    do {
+        start = window->sequence;
+        LSQ_BARRIER();
+        *sums = window->sums;
+        LSQ_BARRIER();
+    } while ((start & 1) || start != window->sequence);
+}
+
+// Function lsqFit:
+// Fits y = c0 + c1 i (+ c2 i^2) and evaluates it at the newest edge.
+// Arguments: sums from lsqRead(), tick_hz is the timestamp clock, edges_per_rev converts edges to revolutions
+// Returns: 1 and velocity (rev/s, signed) and acceleration (rev/s^2) if the window holds enough edges, else 0
+int lsqFit(const LsqSums * sums, uint32_t tick_hz, uint32_t edges_per_rev, double * velocity, double * acceleration) {
+    double n = sums->count;
+    if (sums->count < LSQ_ORDER + 1)
+        return 0;
+
+    // Moments of i over 0 .. n-1
+    double m0 = n;
+    double m1 = n * (n - 1) / 2;
+    double m2 = (n - 1) * n * (2 * n - 1) / 6;
+    double t0 = (double) sums->t0;
+    double t1 = (double) sums->t1;
+    double c1, c2 = 0;
+
+#if LSQ_ORDER == 1
+    c1 = (m0 * t1 - m1 * t0) / (m0 * m2 - m1 * m1);
+#else
+    double m3 = m1 * m1;
+    double m4 = (n - 1) * n * (2 * n - 1) * (3 * (n - 1) * (n - 1) + 3 * (n - 1) - 1) / 30;
+    double t2 = (double) sums->t2;
+
+    // Cramer's rule on [m0 m1 m2; m1 m2 m3; m2 m3 m4] c = [t0 t1 t2]
+    double det = m0 * (m2 * m4 - m3 * m3) - m1 * (m1 * m4 - m3 * m2) + m2 * (m1 * m3 - m2 * m2);
+    c1 = (m0 * (t1 * m4 - m3 * t2) - t0 * (m1 * m4 - m3 * m2) + m2 * (m1 * t2 - t1 * m2)) / det;
+    c2 = (m0 * (m2 * t2 - t1 * m3) - m1 * (m1 * t2 - t1 * m2) + t0 * (m1 * m3 - m2 * m2)) / det;
+#endif
+
+    // Ticks per edge at the newest edge
+    double slope = c1 + 2 * c2 * (n - 1);
+    if (slope <= 0)
+        return 0;
+
+    double rev_per_tick = 1.0 / (slope * edges_per_rev);
+    *velocity = sums->direction * rev_per_tick * tick_hz;
+    // d2(edge)/dt2 = -(d2t/di2) / (dt/di)^3
+    *acceleration = sums->direction * (-2 * c2) / (slope * slope * slope) / edges_per_rev * tick_hz * tick_hz;
+    return 1;
+}
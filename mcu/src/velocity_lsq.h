@@ -0,0 +1,48 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 14, 2025
+File function: Header for the sliding-window least-squares velocity/acceleration fit.
+*/
+
+#ifndef VELOCITY_LSQ_H
+#define VELOCITY_LSQ_H
+
+#include <stdint.h>
+
+// Number of edges in the fit window (latency is about LSQ_WINDOW / 2 edges)
+#ifndef LSQ_WINDOW
+#define LSQ_WINDOW 16
+#endif
+
+// 1 = straight line (velocity only), 2 = quadratic (velocity and acceleration)
+#ifndef LSQ_ORDER
+#define LSQ_ORDER 2
+#endif
+
+// Moments of edge time over the window: y_i = time of edge i - time of the oldest edge, i = 0 is oldest
+typedef struct {
+    int64_t t0;        // sum of y_i
+    int64_t t1;        // sum of i * y_i
+    int64_t t2;        // sum of i^2 * y_i
+    uint32_t count;    // edges in the window
+    int32_t direction; // all edges in the window moved this way
+} LsqSums;
+
+typedef struct {
+    volatile uint32_t sequence;   // odd while lsqAddEdge() is updating (see encoder_snapshot.c)
+    LsqSums sums;
+    uint32_t time[LSQ_WINDOW];    // ring of edge timestamps
+    uint32_t oldest;              // ring index of i = 0
+} LsqWindow;
+
+///////////////////////////////////////////////////////////////////////////////
+// Function prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+void lsqReset(LsqWindow * window);
+void lsqAddEdge(LsqWindow * window, uint32_t time, int direction);
+void lsqRead(const LsqWindow * window, LsqSums * sums);
+int lsqFit(const LsqSums * sums, uint32_t tick_hz, uint32_t edges_per_rev, double * velocity, double * acceleration);
+
+#endif // VELOCITY_LSQ_H
@@ -0,0 +1,56 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 13, 2025
+File function: M/T velocity estimator. Instead of inverting a single edge period (few ticks at high speed,
+rare updates at low speed), count the edges M that arrived in a window and divide by the exact time T
+between the first and last of them. Both come from the edge timestamps on the free-running COUNT_TIM,
+so the count never includes a partial edge and accuracy stays flat across the speed range.
+*/
+
+#include "velocity_mt.h"
+
+// Function mtInit:
+// Starts the first window now, treating the current position as if an edge had just occurred
+// Arguments: scale is velocityScale(tick_hz, edges_per_rev) for the position units,
+// position is the current encoder position, now is the current timer value
+void mtInit(MtEstimator * mt, uint32_t scale, quad_position_t position, uint32_t now) {
+    mt->scale = scale;
+    mt->last_position = position;
+    mt->last_edge_time = now;
+    mt->window_start = now;
+    mt->velocity = 0;
+}
+
+// Function mtUpdate:
+// Call periodically with the latest snapshot. Once MT_WINDOW_US has passed the window closes at the
+// latest edge: M = edges since the previous window's last edge, T = time between those two edges.
+// If no edge arrived the window stays open; the estimate is capped at one edge per elapsed time so
+// it decays while slowing, and drops to zero after MT_MAX_WINDOW_US.
+// Returns: velocity magnitude in rev/s (direction comes from the snapshot)
+velocity_q_t mtUpdate(MtEstimator * mt, const EncoderSample * sample, uint32_t now) {
+    if ((now - mt->window_start) < MT_WINDOW_US)
+        return mt->velocity;
+
+    int32_t edges = (int32_t)(sample->position - mt->last_position);
+    uint32_t span = sample->timestamp - mt->last_edge_time;
+
+    if (edges != 0 && span != 0) {
+        mt->velocity = velocityFromSpan(mt->scale, (uint32_t)(edges < 0 ? -edges : edges), span);
+        mt->last_position = sample->position;
+        mt->last_edge_time = sample->timestamp;
+        mt->window_start = now;
+        return mt->velocity;
+    }
+
+    uint32_t idle = now - mt->last_edge_time;
+    if (idle > MT_MAX_WINDOW_US) {
+        mt->velocity = 0;
+    }
+    else {
+        velocity_q_t bound = velocityFromSpan(mt->scale, 1, idle); // next edge can't be sooner than now
+        if (bound < mt->velocity)
+            mt->velocity = bound;
+    }
+    return mt->velocity;
+}
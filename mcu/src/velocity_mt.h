@@ -0,0 +1,33 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 13, 2025
+File function: Header for the M/T (combined frequency/period) velocity estimator.
+*/
+
+#ifndef VELOCITY_MT_H
+#define VELOCITY_MT_H
+
+#include <stdint.h>
+#include "velocity.h"
+#include "encoder_snapshot.h"
+
+#define MT_WINDOW_US     20000  // nominal measurement window (us)
+#define MT_MAX_WINDOW_US 100000 // no edge for this long means stopped (us)
+
+typedef struct {
+    uint32_t scale;                // velocityScale() for one edge
+    quad_position_t last_position; // position at the last edge of the previous window
+    uint32_t last_edge_time;       // time of the last edge of the previous window
+    uint32_t window_start;         // when the current window opened
+    velocity_q_t velocity;         // magnitude, rev/s
+} MtEstimator;
+
+///////////////////////////////////////////////////////////////////////////////
+// Function prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+void mtInit(MtEstimator * mt, uint32_t scale, quad_position_t position, uint32_t now);
+velocity_q_t mtUpdate(MtEstimator * mt, const EncoderSample * sample, uint32_t now);
+
+#endif // VELOCITY_MT_H
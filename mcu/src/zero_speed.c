@@ -0,0 +1,103 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 17, 2025
+File function: Declares the shaft stopped exactly when no edge has arrived within a speed-adaptive window,
+instead of when the main loop next happens to look. Every edge re-arms an output compare on COUNT_TIM
+(channel 3, no pin) for ZERO_SPEED_FACTOR times the last edge period, clamped to
+[ZERO_SPEED_MIN_US, ZERO_SPEED_MAX_US]. ZERO_SPEED_MAX_US is therefore the worst-case detection latency.
+*/
+
+#include "main.h"
+#include "zero_speed.h"
+
+static uint32_t last_edge = 0;      // time of the edge that armed the compare
+static uint32_t window = ZERO_SPEED_MAX_US;
+static volatile int stopped = 1;
+static volatile uint32_t latency = 0;     // last edge -> detection for the most recent stop (us)
+static volatile uint32_t latency_max = 0; // worst latency since reset (us)
+static volatile uint32_t late_max = 0;    // worst compare match -> ISR delay (us)
+
+// Function initZeroSpeed:
+// Sets channel 3 of COUNT_TIM to frozen output compare (interrupt only) and enables its interrupt.
+// COUNT_TIM must already be running.
+// Arguments: now is the current COUNT_TIM time
+void initZeroSpeed(uint32_t now) {
+    COUNT_TIM->CCMR2 &= ~(TIM_CCMR2_CC3S | TIM_CCMR2_OC3M); // output, frozen: no effect on any pin
+    COUNT_TIM->CCER &= ~TIM_CCER_CC3E;
+    last_edge = now;
+    window = ZERO_SPEED_MAX_US;
+    stopped = 1;
+    COUNT_TIM->CCR3 = now + window;
+    COUNT_TIM->SR = (uint32_t)~TIM_SR_CC3IF; // rc_w0: clear only CC3IF
+    COUNT_TIM->DIER |= TIM_DIER_CC3IE;
+
+    NVIC->ISER[0] |= (1 << TIM2_IRQn);
+}
+
+// Function zeroSpeedArm:
+// Restarts the timeout from an edge. Call at the same interrupt priority as TIM2_IRQHandler.
+// Arguments: edge_time is the edge's COUNT_TIM timestamp, edge_period the time since the edge before it
+void zeroSpeedArm(uint32_t edge_time, uint32_t edge_period) {
+    zeroSpeedArmAtLeast(edge_time, edge_period, ZERO_SPEED_MIN_US);
+}
+
+// Function zeroSpeedArmAtLeast:
+// zeroSpeedArm() with a longer shortest window, for edges handed over in batches from the main loop:
+// the window must outlast the gap until the next batch, or every pass would end in a false stop.
+// A deadline already passed fires at once.
+// Arguments: as zeroSpeedArm(), min_window is the shortest timeout (us)
+void zeroSpeedArmAtLeast(uint32_t edge_time, uint32_t edge_period, uint32_t min_window) {
+    uint32_t w = edge_period * ZERO_SPEED_FACTOR;
+    if (edge_period > ZERO_SPEED_MAX_US / ZERO_SPEED_FACTOR || w > ZERO_SPEED_MAX_US)
+        w = ZERO_SPEED_MAX_US;
+    if (w < min_window)
+        w = min_window;
+
+    last_edge = edge_time;
+    window = w;
+    stopped = 0;
+
+    COUNT_TIM->CCR3 = edge_time + w;
+    COUNT_TIM->SR = (uint32_t)~TIM_SR_CC3IF;
+    if ((COUNT_TIM->CNT - edge_time) >= w)
+        COUNT_TIM->EGR = TIM_EGR_CC3G; // deadline already behind us: raise the compare event now
+}
+
+// Function zeroSpeedService:
+// Call from TIM2_IRQHandler
+// Returns: 1 if this call declared the shaft stopped
+int zeroSpeedService(void) {
+    if (!(COUNT_TIM->SR & TIM_SR_CC3IF))
+        return 0;
+    COUNT_TIM->SR = (uint32_t)~TIM_SR_CC3IF;
+
+    uint32_t now = COUNT_TIM->CNT;
+    uint32_t since_edge = now - last_edge;
+    if (stopped || since_edge < window) // already reported, or re-armed after this match was raised
+        return 0;
+
+    stopped = 1;
+    latency = since_edge;
+    if (since_edge > latency_max)
+        latency_max = since_edge;
+    if (since_edge - window > late_max)
+        late_max = since_edge - window;
+    return 1;
+}
+
+int zeroSpeedStopped(void) {
+    return stopped;
+}
+
+uint32_t zeroSpeedLatency(void) {
+    return latency;
+}
+
+uint32_t zeroSpeedLatencyMax(void) {
+    return latency_max;
+}
+
+uint32_t zeroSpeedLateMax(void) {
+    return late_max;
+}
@@ -0,0 +1,26 @@
+/*
+Author: Eoin O'Connell
+Email: eoconnell@hmc.edu
+Date: Nov. 17, 2025
+File function: Header for hardware-timed zero-speed detection on a COUNT_TIM output compare channel.
+*/
+
+#ifndef ZERO_SPEED_H
+#define ZERO_SPEED_H
+
+#include <stdint.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// Function prototypes
+///////////////////////////////////////////////////////////////////////////////
+
+void initZeroSpeed(uint32_t now);
+void zeroSpeedArm(uint32_t edge_time, uint32_t edge_period);
+void zeroSpeedArmAtLeast(uint32_t edge_time, uint32_t edge_period, uint32_t min_window);
+int zeroSpeedService(void);
+int zeroSpeedStopped(void);
+uint32_t zeroSpeedLatency(void);
+uint32_t zeroSpeedLatencyMax(void);
+uint32_t zeroSpeedLateMax(void);
+
+#endif // ZERO_SPEED_H